@@ -0,0 +1,303 @@
+#ifndef BATCH_CPP
+#define BATCH_CPP
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <vector>
+#include <array>
+#include <algorithm>
+
+#include "batch.h"
+
+namespace BigInt
+{
+	inline batch_kernel detect_batch_kernel()
+	{
+#if defined(__x86_64__)
+		if(__builtin_cpu_supports("avx512f")) return batch_kernel::avx512;
+		if(__builtin_cpu_supports("avx2")) return batch_kernel::avx2;
+#endif
+		return batch_kernel::scalar;
+	}
+
+	inline batch_kernel active_batch = detect_batch_kernel(); // initialized once at startup
+
+	inline batch_kernel active_batch_kernel()
+	{
+		return active_batch;
+	}
+
+	inline bool select_batch_kernel(batch_kernel kernel)
+	{
+		const batch_kernel best = detect_batch_kernel();
+		if(kernel == batch_kernel::avx512 && best != batch_kernel::avx512) return false;
+		if(kernel == batch_kernel::avx2 && best == batch_kernel::scalar) return false;
+		active_batch = kernel;
+		return true;
+	}
+
+	inline constexpr const char *batch_kernel_name(batch_kernel kernel)
+	{
+		switch(kernel) {
+			case batch_kernel::avx2: return "avx2";
+			case batch_kernel::avx512: return "avx512";
+			default: return "scalar";
+		}
+	}
+
+	inline constexpr size_t batch_lanes(batch_kernel kernel)
+	{
+		switch(kernel) {
+			case batch_kernel::avx2: return 4;
+			case batch_kernel::avx512: return 8;
+			default: return 1;
+		}
+	}
+
+	namespace lanes
+	{
+		inline constexpr size_t digit_count(size_t mod_bits)
+		{
+			return (mod_bits+2+digit_bits-1)/digit_bits;
+		}
+
+		inline void to_digits(uint64_t *d, size_t digits, size_t lanes, size_t lane, const uint64_t *x, size_t xn)
+		{
+			for(size_t j=0;j<digits;j++) {
+				const size_t q = j*digit_bits/64, s = j*digit_bits%64;
+				uint64_t v = 0;
+				if(q < xn) v = x[xn-1-q] >> s;
+				if(s > 64-digit_bits && q+1 < xn) v |= x[xn-2-q] << (64-s);
+				d[j*lanes+lane] = v & digit_mask;
+			}
+		}
+
+		inline void from_digits(uint64_t *x, size_t xn, const uint64_t *d, size_t digits, size_t lanes, size_t lane)
+		{
+			std::fill(x, x+xn, 0);
+			for(size_t j=0;j<digits;j++) {
+				const size_t q = j*digit_bits/64, s = j*digit_bits%64;
+				const uint64_t v = d[j*lanes+lane];
+				if(q < xn) x[xn-1-q] |= v << s;
+				if(s > 64-digit_bits && q+1 < xn) x[xn-2-q] |= v >> (64-s);
+			}
+		}
+
+#if defined(__x86_64__)
+		typedef uint64_t u64x4 __attribute__((vector_size(32)));
+		typedef uint64_t u64x8 __attribute__((vector_size(64)));
+
+		// The generic kernels below only use vector extensions and inline asm, they are always inlined into the
+		// target specific wrappers so the same code is compiled once for AVX2 and once for AVX-512
+
+		// low 32 bits of every lane of a times the low 32 bits of b
+		template<typename vec_type>
+		[[gnu::always_inline]] inline void mul_32x32(vec_type &r, const vec_type &a, const vec_type &b)
+		{
+			__asm__("vpmuludq %2, %1, %0" : "=v" (r) : "v" (a), "v" (b));
+		}
+
+		template<typename vec_type>
+		[[gnu::always_inline]] inline void mont_mul_lanes(vec_type *r, const vec_type *a, const vec_type *b, const vec_type *n,
+		                                                  const vec_type &n0inv, size_t digits, vec_type *t)
+		{
+			const vec_type mask = vec_type{}+digit_mask;
+			for(size_t j=0;j<=2*digits;j++) t[j] = vec_type{};
+
+			// word by word reduction in a sliding window like limb::mont_mul, but the carries stay in the lanes.
+			// Every digit takes two products < 2^58 per step, so they are only propagated every 16 steps
+			for(size_t i=0;i<digits;i++) {
+				vec_type *window = t+i;
+				vec_type p, m;
+				mul_32x32(p, a[i], b[0]);
+				mul_32x32(m, (window[0]+p) & mask, n0inv);
+				m &= mask;
+
+				// window += a[i]*b + m*n, the lowest digit becomes a multiple of 2^29
+				for(size_t j=0;j<digits;j++) {
+					vec_type ab, mn;
+					mul_32x32(ab, a[i], b[j]);
+					mul_32x32(mn, m, n[j]);
+					window[j] += ab+mn;
+				}
+				window[1] += window[0] >> digit_bits;
+
+				if(i%16 == 15) {
+					for(size_t j=1;j<digits;j++) {
+						window[j+1] += window[j] >> digit_bits;
+						window[j] &= mask;
+					}
+				}
+			}
+
+			for(size_t j=digits;j<2*digits;j++) {
+				t[j+1] += t[j] >> digit_bits;
+				r[j-digits] = t[j] & mask;
+			}
+		}
+
+		template<typename vec_type>
+		[[gnu::always_inline]] inline void select_lanes(vec_type *r, const vec_type *table, size_t entries, const vec_type &idx, size_t digits)
+		{
+			for(size_t j=0;j<digits;j++) r[j] = vec_type{};
+			for(size_t e=0;e<entries;e++) {
+				const vec_type mask = (vec_type)(idx == vec_type{}+e);
+				for(size_t j=0;j<digits;j++) r[j] |= table[e*digits+j] & mask;
+			}
+		}
+
+		__attribute__((target("avx2")))
+		inline void mont_mul_avx2(uint64_t *r, const uint64_t *a, const uint64_t *b, const uint64_t *n,
+		                          const uint64_t *n0inv, size_t digits, uint64_t *t)
+		{
+			mont_mul_lanes((u64x4 *)r, (const u64x4 *)a, (const u64x4 *)b, (const u64x4 *)n, *(const u64x4 *)n0inv, digits, (u64x4 *)t);
+		}
+
+		__attribute__((target("avx512f")))
+		inline void mont_mul_avx512(uint64_t *r, const uint64_t *a, const uint64_t *b, const uint64_t *n,
+		                            const uint64_t *n0inv, size_t digits, uint64_t *t)
+		{
+			mont_mul_lanes((u64x8 *)r, (const u64x8 *)a, (const u64x8 *)b, (const u64x8 *)n, *(const u64x8 *)n0inv, digits, (u64x8 *)t);
+		}
+
+		__attribute__((target("avx2")))
+		inline void select_avx2(uint64_t *r, const uint64_t *table, size_t entries, const uint64_t *idx, size_t digits)
+		{
+			select_lanes((u64x4 *)r, (const u64x4 *)table, entries, *(const u64x4 *)idx, digits);
+		}
+
+		__attribute__((target("avx512f")))
+		inline void select_avx512(uint64_t *r, const uint64_t *table, size_t entries, const uint64_t *idx, size_t digits)
+		{
+			select_lanes((u64x8 *)r, (const u64x8 *)table, entries, *(const u64x8 *)idx, digits);
+		}
+#endif
+
+		inline void mont_mul(batch_kernel kernel, uint64_t *r, const uint64_t *a, const uint64_t *b, const uint64_t *n,
+		                     const uint64_t *n0inv, size_t digits, uint64_t *t)
+		{
+#if defined(__x86_64__)
+			if(kernel == batch_kernel::avx512) mont_mul_avx512(r, a, b, n, n0inv, digits, t);
+			else mont_mul_avx2(r, a, b, n, n0inv, digits, t);
+#endif
+		}
+
+		inline void select(batch_kernel kernel, uint64_t *r, const uint64_t *table, size_t entries, const uint64_t *idx, size_t digits)
+		{
+#if defined(__x86_64__)
+			if(kernel == batch_kernel::avx512) select_avx512(r, table, entries, idx, digits);
+			else select_avx2(r, table, entries, idx, digits);
+#endif
+		}
+
+		template<typename uint_type>
+		void powmod_group(batch_kernel kernel, const powmod_job<uint_type> *jobs, const size_t *index, size_t count, uint_type *results)
+		{
+			constexpr const size_t op_size = uint_type::__get_op_size();
+			constexpr const size_t entries = 1 << window_bits;
+			const size_t lanes = batch_lanes(kernel);
+			auto job = [&](size_t lane) -> const powmod_job<uint_type> & { return jobs[index[std::min(lane, count-1)]]; };
+
+			// the group shares the digit count of its largest modulus and the window count of its longest exponent
+			size_t mod_bits = 0, exp_bits = 0;
+			for(size_t l=0;l<count;l++) {
+				mod_bits = std::max(mod_bits, limb::bit_length(job(l).mod.__get_op(), op_size));
+				exp_bits = std::max(exp_bits, limb::bit_length(job(l).exp.__get_op(), op_size));
+			}
+			const size_t digits = digit_count(mod_bits);
+			const size_t stride = digits*lanes; // limbs of one interleaved number
+
+			// one allocation per group, aligned for the widest vector
+			std::vector<uint64_t> buffer((entries+5)*stride + (2*digits+1)*lanes + 2*lanes + 8);
+			uint64_t *work = buffer.data() + (8 - (reinterpret_cast<uintptr_t>(buffer.data())/8)%8)%8;
+			uint64_t *n = work, *base = n+stride, *acc = base+stride, *sel = acc+stride, *one = sel+stride;
+			uint64_t *table = one+stride, *t = table+entries*stride, *n0inv = t+(2*digits+1)*lanes, *idx = n0inv+lanes;
+
+			// base*R mod n and R mod n with R = 2^(29*digits) <= 2^(64*op_size+30), through one long division each
+			const size_t shift_limbs = digits*digit_bits/64, shift_bits = digits*digit_bits%64;
+			std::array<uint64_t, 2*op_size+1> num;
+			std::array<uint64_t, op_size> rem;
+			std::array<uint64_t, 3*op_size+2> scratch;
+			auto to_mont = [&](const uint64_t *x, uint64_t *d, size_t lane, const uint64_t *mod) {
+				const size_t xn = op_size+shift_limbs+1;
+				std::fill(num.begin(), num.begin()+xn, 0);
+				std::copy(x, x+op_size, num.begin()+1);
+				limb::lshift(num.data(), num.data(), xn, shift_bits);
+				limb::divrem(nullptr, rem.data(), num.data(), xn, mod, op_size, scratch.data());
+				to_digits(d, digits, lanes, lane, rem.data(), op_size);
+			};
+
+			std::array<uint64_t, op_size> one_limbs{};
+			one_limbs[op_size-1] = 1;
+			for(size_t l=0;l<lanes;l++) {
+				const uint64_t *mod = job(l).mod.__get_op();
+				to_digits(n, digits, lanes, l, mod, op_size);
+				n0inv[l] = limb::mont_n0inv(mod[op_size-1]) & digit_mask;
+				to_mont(job(l).base.__get_op(), base, l, mod);
+				to_mont(one_limbs.data(), one, l, mod);
+			}
+
+			// table of base^0..base^(2^w-1) in Montgomery form
+			std::copy(one, one+stride, table);
+			std::copy(base, base+stride, table+stride);
+			for(size_t e=2;e<entries;e++) mont_mul(kernel, table+e*stride, table+(e-1)*stride, base, n, n0inv, digits, t);
+
+			// fixed windows from the top, every lane squares and multiplies the same number of times
+			std::copy(one, one+stride, acc);
+			const size_t windows = (exp_bits+window_bits-1)/window_bits;
+			for(size_t w=windows;w --> 0;) {
+				if(w+1 != windows) {
+					for(unsigned s=0;s<window_bits;s++) mont_mul(kernel, acc, acc, acc, n, n0inv, digits, t);
+				}
+				const size_t bit = w*window_bits;
+				for(size_t l=0;l<lanes;l++) idx[l] = (job(l).exp.__get_op()[op_size-1-bit/64] >> bit%64) & (entries-1);
+				select(kernel, sel, table, entries, idx, digits);
+				mont_mul(kernel, acc, acc, sel, n, n0inv, digits, t);
+			}
+
+			// out of Montgomery form by multiplying with 1, the result is at most n
+			std::fill(sel, sel+stride, 0);
+			std::fill(sel, sel+lanes, 1);
+			mont_mul(kernel, acc, acc, sel, n, n0inv, digits, t);
+			for(size_t l=0;l<count;l++) {
+				uint_type &ret = results[index[l]];
+				uint64_t *ret_op = ret.__get_op();
+				const uint64_t *mod = job(l).mod.__get_op();
+				from_digits(ret_op, op_size, acc, digits, lanes, l);
+				if(limb::cmp(ret_op, mod, op_size) >= 0) limb::sub_n(ret_op, ret_op, mod, op_size);
+			}
+		}
+	}; /* NAMESPACE LANES */
+
+	template<typename uint_type>
+	std::span<uint_type> powmod_batch(std::span<const powmod_job<uint_type>> jobs, std::span<uint_type> results)
+	{
+		constexpr const size_t op_size = uint_type::__get_op_size();
+		if(results.size() < jobs.size())
+			throw batch_size_error("powmod_batch needs room for a result per job");
+
+		const batch_kernel kernel = active_batch_kernel();
+		const size_t group_size = batch_lanes(kernel);
+
+		// even moduli need Barrett reduction, they and a short tail run one by one
+		std::vector<size_t> odd;
+		odd.reserve(jobs.size());
+		for(size_t i=0;i<jobs.size();i++) {
+			if(kernel != batch_kernel::scalar && (jobs[i].mod.__get_op()[op_size-1] & 1)) odd.push_back(i);
+			else results[i] = powmod(jobs[i].base, jobs[i].exp, jobs[i].mod);
+		}
+
+		size_t i = 0;
+		for(;i<odd.size();i+=group_size) {
+			const size_t count = std::min(group_size, odd.size()-i);
+			if(2*count < group_size) break; // less than half full, the scalar powmod is faster
+			lanes::powmod_group(kernel, jobs.data(), odd.data()+i, count, results.data());
+		}
+		for(;i<odd.size();i++) results[odd[i]] = powmod(jobs[odd[i]].base, jobs[odd[i]].exp, jobs[odd[i]].mod);
+
+		return results.first(jobs.size());
+	}
+}; /* NAMESPACE BIGINT */
+
+#endif /* BATCH_CPP */
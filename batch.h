@@ -0,0 +1,88 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+
+#include "bigint.h"
+#include "modular.h"
+
+// Multi-buffer modular exponentiation. Independent powmod jobs with odd moduli run in lockstep in the 64-bit lanes of
+// AVX2 (4 lanes) or AVX-512 (8 lanes) registers. Numbers are stored in radix 2^29 so every digit product is a single
+// 32x32->64 bit vpmuludq and up to 32 products fit in a lane before carries have to be propagated
+
+namespace BigInt
+{
+	// raise when a batch doesn't have room for its results
+	class batch_size_error : public std::runtime_error {
+		public: explicit batch_size_error(const char *str) : std::runtime_error(str) {}
+	};
+
+	// one base^exp mod mod
+	template<typename uint_type>
+	struct powmod_job
+	{
+		uint_type base;
+		uint_type exp;
+		uint_type mod;
+	};
+
+	// the scalar kernel runs every job through powmod
+	enum class batch_kernel { scalar, avx2, avx512 };
+
+	// widest batch kernel the cpu supports, picked once at startup
+	inline batch_kernel detect_batch_kernel();
+
+	inline batch_kernel active_batch_kernel();
+
+	// switch batch kernels, returns false and keeps the current one if the cpu doesn't support kernel
+	inline bool select_batch_kernel(batch_kernel kernel);
+
+	inline constexpr const char *batch_kernel_name(batch_kernel kernel);
+
+	// jobs that run at once with kernel
+	inline constexpr size_t batch_lanes(batch_kernel kernel);
+
+	// results[i] = jobs[i].base^jobs[i].exp mod jobs[i].mod, returns the first jobs.size() results.
+	// Odd moduli are grouped by the number of lanes, even moduli and a short tail go through the scalar powmod.
+	// The vector kernels use fixed windows and read every table entry, so the run time only depends on the
+	// longest exponent and the largest modulus of a group
+	template<typename uint_type>
+	std::span<uint_type> powmod_batch(std::span<const powmod_job<uint_type>> jobs, std::span<uint_type> results);
+
+	namespace lanes
+	{
+		constexpr const unsigned digit_bits = 29;
+		constexpr const uint64_t digit_mask = (uint64_t(1) << digit_bits)-1;
+		constexpr const unsigned window_bits = 4; // divides 64, so a window never straddles exponent limbs
+
+		// radix 2^29 digits for a modulus of mod_bits bits. R = 2^(29*digits) > 4*mod, which keeps every
+		// Montgomery product below 2*mod without a final subtraction
+		inline constexpr size_t digit_count(size_t mod_bits);
+
+		// digits d[j*lanes+lane] of x[xn] (big-endian 64-bit limbs)
+		inline void to_digits(uint64_t *d, size_t digits, size_t lanes, size_t lane, const uint64_t *x, size_t xn);
+
+		// x[xn] from digits d[j*lanes+lane], digits above 64*xn bits have to be zero
+		inline void from_digits(uint64_t *x, size_t xn, const uint64_t *d, size_t digits, size_t lanes, size_t lane);
+
+		// lane-wise Montgomery product r = a*b*R^-1 mod n with every digit array interleaved by lane (a[j*lanes+lane]).
+		// a and b have to be less than 2n, so is r. t holds 2*digits+1 vectors. r can be a or b
+		inline void mont_mul(batch_kernel kernel, uint64_t *r, const uint64_t *a, const uint64_t *b, const uint64_t *n,
+		                     const uint64_t *n0inv, size_t digits, uint64_t *t);
+
+		// r = table[idx] for every lane, reading all entries
+		inline void select(batch_kernel kernel, uint64_t *r, const uint64_t *table, size_t entries, const uint64_t *idx, size_t digits);
+
+		// runs jobs[index[0..count-1]] in one group of batch_lanes(kernel) lanes, count <= lanes. Unused lanes repeat the last job
+		template<typename uint_type>
+		void powmod_group(batch_kernel kernel, const powmod_job<uint_type> *jobs, const size_t *index, size_t count, uint_type *results);
+	}; /* NAMESPACE LANES */
+}; /* NAMESPACE BIGINT */
+
+// include here because of template class and function
+#include "batch.cpp"
+
+#endif /* BATCH_H */
@@ -0,0 +1,416 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <stdint.h>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <thread>
+
+#include "bigint.h"
+#include "modular.h"
+#include "batch.h"
+#include "prime.h"
+#include "rsa.h"
+
+// benchmarks for the big integer and RSA hot paths. Build with `make bench`
+
+std::mt19937_64 bench_generator(0x5eed);
+
+// microseconds per call of fn, averaged over iterations
+template<typename function_type>
+double time_per_call(function_type fn, size_t iterations)
+{
+	auto start = std::chrono::steady_clock::now();
+	for(size_t i=0;i<iterations;i++) fn();
+	std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count()/iterations;
+}
+
+// random number with exactly bits significant bits
+template<typename uint_type>
+uint_type random_bits(size_t bits)
+{
+	constexpr const size_t op_size = uint_type::__get_op_size();
+	uint_type ret = 0;
+	uint64_t *op = ret.__get_op();
+	for(size_t i=0;i<(bits+63)/64;i++) op[op_size-1-i] = bench_generator();
+	if(bits%64 != 0) op[op_size-1-(bits-1)/64] &= UINT64_MAX >> (64-bits%64);
+	op[op_size-1-(bits-1)/64] |= uint64_t(1) << ((bits-1)%64);
+	return ret;
+}
+
+// variable-time sliding window against the constant-time fixed window exponentiation
+template<uint16_t bitsize>
+void bench_powmod(size_t iterations)
+{
+	typedef BigInt::BigUint<bitsize> uint_type;
+	uint_type mod = random_bits<uint_type>(bitsize);
+	mod.__get_op()[uint_type::__get_op_size()-1] |= 1;
+	const uint_type base = random_bits<uint_type>(bitsize-1);
+	const uint_type exp = random_bits<uint_type>(bitsize);
+	const BigInt::MontgomeryContext<uint_type> ctx(mod);
+
+	uint_type sink;
+	double variable_time = time_per_call([&]() { sink = BigInt::powmod(base, exp, ctx); }, iterations);
+	double constant_time = time_per_call([&]() { sink = BigInt::powmod_ct(base, exp, ctx); }, iterations);
+	std::cout << "powmod " << std::setw(5) << bitsize << "-bit:\tvariable-time " << std::setw(10) << variable_time
+	          << " us\tconstant-time " << std::setw(10) << constant_time << " us\toverhead "
+	          << std::setprecision(3) << (constant_time/variable_time-1)*100 << "%" << std::setprecision(6) << std::endl;
+}
+
+// hex parse and format through caller buffers
+template<uint16_t bitsize>
+void bench_hex(size_t iterations)
+{
+	typedef BigInt::BigUint<bitsize> uint_type;
+	uint_type num = random_bits<uint_type>(bitsize);
+	std::array<char, BigInt::max_chars<uint_type>(16)> buffer;
+	const char *end = BigInt::to_chars(buffer.data(), buffer.data()+buffer.size(), num, 16).ptr;
+
+	double parse = time_per_call([&]() { BigInt::from_chars(buffer.data(), end, num, 16); }, iterations);
+	double format = time_per_call([&]() { BigInt::to_chars(buffer.data(), buffer.data()+buffer.size(), num, 16); }, iterations);
+	std::cout << "hex    " << std::setw(5) << bitsize << "-bit:\tfrom_chars " << std::setw(10) << parse*1000
+	          << " ns\tto_chars " << std::setw(10) << format*1000 << " ns" << std::endl;
+}
+
+// fixed-length big-endian bytes, the wire format next to a hex round trip
+template<uint16_t bitsize>
+void bench_bytes(size_t iterations)
+{
+	typedef BigInt::BigUint<bitsize> uint_type;
+	uint_type num = random_bits<uint_type>(bitsize);
+	std::array<std::byte, bitsize/8> buffer;
+	num.to_bytes(buffer);
+
+	double parse = time_per_call([&]() { num = uint_type::from_bytes(buffer); }, iterations);
+	volatile std::byte sink;
+	double format = time_per_call([&]() { num.to_bytes(buffer); sink = buffer[0]; }, iterations);
+	std::cout << "bytes  " << std::setw(5) << bitsize << "-bit:\tfrom_bytes " << std::setw(10) << parse*1000
+	          << " ns\tto_bytes " << std::setw(10) << format*1000 << " ns" << std::endl;
+}
+
+// decimal parse and format, the first call builds the table of powers of 10 for the type
+template<uint16_t bitsize>
+void bench_decimal(size_t iterations)
+{
+	typedef BigInt::BigUint<bitsize> uint_type;
+	uint_type num = random_bits<uint_type>(bitsize);
+	std::array<char, BigInt::max_chars<uint_type>(10)> buffer;
+	const char *end = BigInt::to_chars(buffer.data(), buffer.data()+buffer.size(), num, 10).ptr;
+
+	double parse = time_per_call([&]() { BigInt::from_chars(buffer.data(), end, num, 10); }, iterations);
+	double format = time_per_call([&]() { BigInt::to_chars(buffer.data(), buffer.data()+buffer.size(), num, 10); }, iterations);
+	std::cout << "dec    " << std::setw(5) << bitsize << "-bit:\tfrom_chars " << std::setw(10) << parse
+	          << " us\tto_chars " << std::setw(10) << format << " us" << std::endl;
+}
+
+// operators on values far below the type's size, the significant-limb count bounds every loop.
+// small is one limb (an exponent like 65537), half fills half of the type, full all of it
+template<uint16_t bitsize>
+void bench_magnitudes(size_t iterations)
+{
+	typedef BigInt::BigUint<bitsize> uint_type;
+	const std::array<std::pair<const char *, size_t>, 3> magnitudes = {{{"small", 64}, {"half", bitsize/2}, {"full", bitsize}}};
+	for(auto [name, bits] : magnitudes) {
+		uint_type a = random_bits<uint_type>(bits), b = random_bits<uint_type>(bits);
+		const uint_type divisor = random_bits<uint_type>(std::max<size_t>(bits/2, 64));
+		a.normalize();
+		b.normalize();
+		std::array<uint_type, 2> same = {a, a+uint_type(1)}; // equal down to the last limb, so every significant limb is read
+		uint_type sink;
+		size_t i = 0;
+		volatile bool less;
+		double cmp = time_per_call([&]() { less = same[i&1] < same[(i+1)&1]; i++; }, iterations);
+		double add = time_per_call([&]() { sink = a+b; }, iterations);
+		double mul = time_per_call([&]() { sink = a*b; }, iterations);
+		double shift = time_per_call([&]() { sink = a << uint16_t(3); }, iterations);
+		double mod = time_per_call([&]() { sink = a%divisor; }, iterations);
+		std::cout << "limbs  " << std::setw(5) << bitsize << "-bit " << std::setw(5) << name << ":\tcmp " << std::setw(8) << cmp*1000
+		          << " ns\tadd " << std::setw(8) << add*1000 << " ns\tmul " << std::setw(8) << mul*1000 << " ns\tshift "
+		          << std::setw(8) << shift*1000 << " ns\tmod " << std::setw(8) << mod*1000 << " ns" << std::endl;
+	}
+}
+
+// squaring kernels against the general product of a number with a copy of itself. The plain product uses half-size
+// operands so that nothing is truncated
+template<uint16_t bitsize>
+void bench_sqr(size_t iterations)
+{
+	typedef BigInt::BigUint<bitsize> uint_type;
+	uint_type mod = random_bits<uint_type>(bitsize);
+	mod.__get_op()[uint_type::__get_op_size()-1] |= 1;
+	const BigInt::MontgomeryContext<uint_type> ctx(mod);
+	uint_type a = random_bits<uint_type>(bitsize/2);
+	a.normalize();
+	const uint_type b = a, x = ctx.to_mont(random_bits<uint_type>(bitsize-1)), y = x;
+
+	uint_type sink;
+	double mul = time_per_call([&]() { sink = a*b; }, iterations);
+	double sqr = time_per_call([&]() { sink = a.sqr(); }, iterations);
+	double mont_mul = time_per_call([&]() { sink = ctx.mont_mul(x, y); }, iterations);
+	double mont_sqr = time_per_call([&]() { sink = ctx.mont_sqr(x); }, iterations);
+	std::cout << "sqr    " << std::setw(5) << bitsize << "-bit:	mul " << std::setw(10) << mul*1000 << " ns	sqr " << std::setw(10)
+	          << sqr*1000 << " ns	mont_mul " << std::setw(10) << mont_mul*1000 << " ns	mont_sqr " << std::setw(10) << mont_sqr*1000
+	          << " ns" << std::endl;
+}
+
+// Lehmer gcd and the private exponent e^-1 mod phi for a 65537 public exponent and for a full-size one
+template<uint16_t bitsize>
+void bench_gcd(size_t iterations)
+{
+	typedef BigInt::BigUint<bitsize> uint_type;
+	const uint_type phi = random_bits<uint_type>(bitsize) & ~uint_type(1), e = 65537, a = random_bits<uint_type>(bitsize-1) | uint_type(1);
+	uint_type sink;
+	double gcd = time_per_call([&]() { sink = BigInt::gcd(a, phi); }, iterations);
+	double inverse_small = time_per_call([&]() {
+		try { sink = BigInt::mod_inverse(e, phi); } catch(const BigInt::not_invertible_error &) {}
+	}, iterations);
+	double inverse = time_per_call([&]() {
+		try { sink = BigInt::mod_inverse(a, phi); } catch(const BigInt::not_invertible_error &) {}
+	}, iterations);
+	std::cout << "gcd    " << std::setw(5) << bitsize << "-bit:	gcd " << std::setw(10) << gcd << " us	inverse of 65537 "
+	          << std::setw(10) << inverse_small << " us	inverse " << std::setw(10) << inverse << " us" << std::endl;
+}
+
+// is_probable_prime with the rounds for random candidates on a prime of bits bits (every Miller-Rabin round runs)
+// and on random odd numbers, which the small prime sieve mostly rejects before any exponentiation
+template<uint16_t bitsize>
+void bench_prime(size_t bits, size_t iterations)
+{
+	typedef BigInt::BigUint<bitsize> uint_type;
+	uint_type prime = random_bits<uint_type>(bits) | uint_type(1);
+	while(!BigInt::is_probable_prime(prime, 0)) prime += uint_type(2);
+	std::vector<uint_type> candidates(iterations);
+	for(auto &c : candidates) c = random_bits<uint_type>(bits) | uint_type(1);
+
+	volatile bool sink;
+	double on_prime = time_per_call([&]() { sink = BigInt::is_probable_prime(prime, 0); }, iterations);
+	size_t i = 0;
+	double on_random = time_per_call([&]() { sink = BigInt::is_probable_prime(candidates[i++], 0); }, iterations);
+	std::cout << "prime  " << std::setw(5) << bits << "-bit:	prime " << std::setw(10) << on_prime << " us ("
+	          << BigInt::prime::miller_rabin_rounds(bits) << " rounds)	random odd " << std::setw(10) << on_random << " us" << std::endl;
+}
+
+// generate_prime against drawing random odd numbers until is_probable_prime accepts one
+template<uint16_t bitsize>
+void bench_generate_prime(size_t bits, size_t iterations)
+{
+	typedef BigInt::BigUint<bitsize> uint_type;
+	uint_type sink;
+	double sieved = time_per_call([&]() { sink = BigInt::generate_prime<uint_type>(bits); }, iterations);
+	double naive = time_per_call([&]() {
+		do sink = random_bits<uint_type>(bits) | uint_type(1); while(!BigInt::is_probable_prime(sink, 0));
+	}, iterations);
+	std::cout << "genprm " << std::setw(5) << bits << "-bit:	sieve " << std::setw(10) << sieved/1000 << " ms	random candidates "
+	          << std::setw(10) << naive/1000 << " ms" << std::endl;
+}
+
+// keypairs per second of Rsa::generate_keypair for 1, 2, 4, ... threads up to the hardware threads
+template<uint16_t bitsize>
+void bench_keygen(size_t iterations)
+{
+	typedef BigInt::BigUint<bitsize> uint_type;
+	Rsa<uint_type> rsa;
+	const size_t hardware = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	std::cout << "keygen " << std::setw(5) << bitsize << "-bit:";
+	for(size_t threads=1;;threads=std::min(threads*2, hardware)) {
+		double t = time_per_call([&]() { rsa.generate_keypair(bitsize, threads); }, iterations);
+		std::cout << "\t" << threads << " threads " << std::setw(8) << 1e6/t << " keys/s";
+		if(threads == hardware) break;
+	}
+	std::cout << std::endl;
+}
+
+// private key operation over n against the CRT key with and without the fault check
+template<uint16_t bitsize>
+void bench_crt(size_t iterations)
+{
+	typedef BigInt::BigUint<bitsize> uint_type;
+	Rsa<uint_type> rsa;
+	const auto keys = rsa.generate_keypair(bitsize, 1);
+	const auto crt = rsa.gen_crt_key(keys.p, keys.q, keys.pub_key, keys.priv_key);
+	const uint_type c = random_bits<uint_type>(bitsize-1);
+
+	uint_type sink;
+	double full = time_per_call([&]() { sink = rsa.private_op(c, keys.n, keys.priv_key); }, iterations);
+	double unchecked = time_per_call([&]() { sink = rsa.private_op(c, crt, false); }, iterations);
+	double checked = time_per_call([&]() { sink = rsa.private_op(c, crt, true); }, iterations);
+	std::cout << "rsa_dp " << std::setw(5) << bitsize << "-bit:	mod n " << std::setw(10) << full << " us	crt " << std::setw(10) << unchecked
+	          << " us	crt+check " << std::setw(10) << checked << " us	(x" << full/unchecked << ", x" << full/checked << ")" << std::endl;
+}
+
+// private key operation with 2 up to max_primes primes, the exponentiations one after another and on a thread each
+template<uint16_t bitsize>
+void bench_multi_prime(size_t iterations)
+{
+	typedef BigInt::BigUint<bitsize> uint_type;
+	Rsa<uint_type> rsa;
+	const uint_type c = random_bits<uint_type>(bitsize-1);
+
+	uint_type sink;
+	std::cout << "mprime " << std::setw(5) << bitsize << "-bit:";
+	for(size_t primes=2;primes<=Rsa<uint_type>::max_primes(bitsize);primes++) {
+		const auto key = rsa.generate_multi_prime_key(bitsize, primes, 1);
+		double serial = time_per_call([&]() { sink = rsa.private_op(c, key, false, false); }, iterations);
+		double parallel = time_per_call([&]() { sink = rsa.private_op(c, key, false, true); }, iterations);
+		std::cout << "\t" << primes << " primes " << std::setw(10) << serial << " us, threaded " << std::setw(10) << parallel << " us";
+	}
+	std::cout << std::endl;
+}
+
+// a 1 KB message one character per block against packed blocks with each padding, decryption with the CRT key
+template<uint16_t bitsize>
+void bench_message(size_t iterations)
+{
+	typedef BigInt::BigUint<bitsize> uint_type;
+	Rsa<uint_type> rsa;
+	const auto keys = rsa.generate_keypair(bitsize, 1);
+	const auto crt = rsa.gen_crt_key(keys.p, keys.q, keys.pub_key, keys.priv_key);
+	std::string text(1024, '0');
+	for(char &ch : text) ch = '0'+random_bits<uint_type>(6).__get_op()[uint_type::__get_op_size()-1];
+	const std::span<const std::byte> message(reinterpret_cast<const std::byte *>(text.data()), text.size());
+
+	std::vector<std::byte> ct(text.size()*rsa.block_size(keys.n));
+	double enc = time_per_call([&]() { rsa.encrypt(text, keys.n, keys.pub_key, ct); }, iterations);
+	double dec = time_per_call([&]() { (void)rsa.decrypt(std::span<const std::byte>(ct), crt); }, iterations);
+	std::cout << "msg1k  " << std::setw(5) << bitsize << "-bit:	per char enc " << std::setw(10) << enc/1000 << " ms dec " << std::setw(10) << dec/1000
+	          << " ms " << std::setw(7) << ct.size() << " bytes";
+	for(auto s : {Padding::scheme::pkcs1_v15, Padding::scheme::oaep}) {
+		std::vector<std::byte> packed;
+		enc = time_per_call([&]() { packed = rsa.encrypt_message(message, keys.n, keys.pub_key, s); }, iterations);
+		dec = time_per_call([&]() { (void)rsa.decrypt_message(packed, crt); }, iterations);
+		std::cout << "\t" << (s == Padding::scheme::oaep ? "oaep" : "v1.5") << " enc " << std::setw(8) << enc/1000 << " ms dec "
+		          << std::setw(8) << dec/1000 << " ms " << std::setw(5) << packed.size() << " bytes";
+	}
+	std::cout << std::endl;
+}
+
+// hybrid RSA-KEM + ChaCha20-Poly1305 throughput on a 64 MB payload against OAEP blocks on 64 KB
+template<uint16_t bitsize>
+void bench_hybrid(size_t iterations)
+{
+	typedef BigInt::BigUint<bitsize> uint_type;
+	Rsa<uint_type> rsa;
+	const auto keys = rsa.generate_keypair(bitsize, 1);
+	const auto crt = rsa.gen_crt_key(keys.p, keys.q, keys.pub_key, keys.priv_key);
+	std::vector<std::byte> payload(64 << 20), small(64 << 10);
+	for(size_t i=0;i<payload.size();i++) payload[i] = std::byte(i*31);
+
+	std::vector<std::byte> ct, out;
+	double enc = time_per_call([&]() { ct = rsa.hybrid_encrypt(payload, keys.n, keys.pub_key); }, iterations);
+	double dec = time_per_call([&]() { out = rsa.hybrid_decrypt(ct, crt); }, iterations);
+	// streaming 1 MB at a time into a reused buffer, as a file or socket would be
+	const size_t piece = 1 << 20;
+	double stream = time_per_call([&]() {
+		out.clear();
+		Aead::StreamEncryptor encryptor = rsa.hybrid_encryptor(keys.n, keys.pub_key, out);
+		for(size_t i=0;i<payload.size();i+=piece) {
+			out.clear();
+			encryptor.update(std::span<const std::byte>(payload).subspan(i, piece), out);
+		}
+		encryptor.finish(out);
+	}, iterations);
+	double blocks = time_per_call([&]() { ct = rsa.encrypt_message(small, keys.n, keys.pub_key); }, iterations);
+	// bytes per microsecond is MB/s
+	std::cout << "hybrid " << std::setw(5) << bitsize << "-bit:	enc " << std::setw(8) << payload.size()/enc << " MB/s	dec " << std::setw(8)
+	          << payload.size()/dec << " MB/s	stream enc " << std::setw(8) << payload.size()/stream << " MB/s	oaep blocks enc "
+	          << std::setw(8) << small.size()/blocks << " MB/s" << std::endl;
+}
+
+// the same exponentiation with every kernel set the cpu supports
+template<uint16_t bitsize>
+void bench_kernels(size_t iterations)
+{
+	typedef BigInt::BigUint<bitsize> uint_type;
+	uint_type mod = random_bits<uint_type>(bitsize);
+	mod.__get_op()[uint_type::__get_op_size()-1] |= 1;
+	const uint_type base = random_bits<uint_type>(bitsize-1);
+	const uint_type exp = random_bits<uint_type>(bitsize);
+	const BigInt::MontgomeryContext<uint_type> ctx(mod);
+	const BigInt::limb::kernel_set detected = BigInt::limb::active_kernel_set();
+
+	uint_type sink;
+	std::cout << "kernels" << std::setw(5) << bitsize << "-bit:";
+	for(auto ks : {BigInt::limb::kernel_set::portable, BigInt::limb::kernel_set::mulx_adx}) {
+		if(!BigInt::limb::select_kernel_set(ks)) continue;
+		double t = time_per_call([&]() { sink = BigInt::powmod(base, exp, ctx); }, iterations);
+		std::cout << "\t" << BigInt::limb::kernel_set_name(ks) << " " << std::setw(10) << t << " us";
+	}
+	std::cout << std::endl;
+	BigInt::limb::select_kernel_set(detected);
+}
+
+// throughput of powmod_batch per kernel on 16 independent jobs, against one powmod per job
+template<uint16_t bitsize>
+void bench_batch(size_t iterations)
+{
+	typedef BigInt::BigUint<bitsize> uint_type;
+	std::vector<BigInt::powmod_job<uint_type>> jobs(16);
+	for(auto &job : jobs) {
+		job.mod = random_bits<uint_type>(bitsize);
+		job.mod.__get_op()[uint_type::__get_op_size()-1] |= 1;
+		job.base = random_bits<uint_type>(bitsize-1);
+		job.exp = random_bits<uint_type>(bitsize);
+	}
+	std::vector<uint_type> results(jobs.size());
+	const BigInt::batch_kernel detected = BigInt::active_batch_kernel();
+
+	std::cout << "batch  " << std::setw(5) << bitsize << "-bit:";
+	for(auto kernel : {BigInt::batch_kernel::scalar, BigInt::batch_kernel::avx2, BigInt::batch_kernel::avx512}) {
+		if(!BigInt::select_batch_kernel(kernel)) continue;
+		double t = time_per_call([&]() { BigInt::powmod_batch<uint_type>(jobs, results); }, iterations)/jobs.size();
+		std::cout << "\t" << BigInt::batch_kernel_name(kernel) << " " << std::setw(10) << t << " us/op";
+	}
+	std::cout << std::endl;
+	BigInt::select_batch_kernel(detected);
+}
+
+int main()
+{
+	std::cout << std::fixed;
+	bench_hex<256>(1000000);
+	bench_hex<2048>(200000);
+	bench_bytes<256>(1000000);
+	bench_bytes<2048>(1000000);
+	bench_decimal<1024>(20000);
+	bench_decimal<2048>(10000);
+	bench_decimal<4096>(3000);
+	bench_decimal<8192>(1000);
+	bench_decimal<16384>(300);
+	bench_magnitudes<1024>(100000);
+	bench_magnitudes<4096>(20000);
+	bench_sqr<1024>(100000);
+	bench_sqr<4096>(20000);
+	bench_sqr<16384>(2000);
+	bench_gcd<1024>(2000);
+	bench_gcd<2048>(1000);
+	bench_gcd<4096>(300);
+	bench_prime<1024>(512, 200);
+	bench_prime<2048>(1024, 50);
+	bench_prime<4096>(2048, 10);
+	bench_generate_prime<1024>(512, 40);
+	bench_generate_prime<1024>(1024, 20);
+	bench_generate_prime<2048>(2048, 3);
+	bench_keygen<1024>(20);
+	bench_keygen<2048>(5);
+	bench_crt<1024>(200);
+	bench_crt<2048>(50);
+	bench_crt<4096>(10);
+	bench_multi_prime<2048>(50);
+	bench_multi_prime<3072>(20);
+	bench_multi_prime<4096>(10);
+	bench_message<2048>(1);
+	bench_hybrid<2048>(3);
+	std::cout << "active kernel set: " << BigInt::limb::kernel_set_name(BigInt::limb::active_kernel_set()) << std::endl;
+	bench_kernels<1024>(200);
+	bench_kernels<2048>(50);
+	bench_kernels<4096>(10);
+	std::cout << "active batch kernel: " << BigInt::batch_kernel_name(BigInt::active_batch_kernel()) << std::endl;
+	bench_batch<1024>(10);
+	bench_batch<2048>(3);
+	bench_powmod<1024>(200);
+	bench_powmod<2048>(50);
+	bench_powmod<4096>(10);
+}
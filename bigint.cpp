@@ -12,6 +12,7 @@
 #include <cassert>
 #include <vector>
 #include <limits>
+#include <algorithm>
 
 
 #include "bigint.h"
@@ -125,7 +126,7 @@ namespace BigInt
 	
 	    // add input to operator array
 	    for(bitsize_t i=op_size;i --> pad_count;) op[i] = input[i];
-		op_nonleading_i = pad_count;
+		normalize_from(0);
 	}
 
 	// helper function to assign compile time array so that it can be assigned to op as compile time
@@ -171,6 +172,7 @@ namespace BigInt
 	
 	    	// add input to operator array
 	    	for(bitsize_t i=op_size;i --> pad_count;) op[i] = input[i];
+			op_nonleading_i = pad_count;
 		}
 		return *this;
 	}
@@ -179,31 +181,32 @@ namespace BigInt
 	// copy assignment operator
 	template<typename bitsize_t>
 	template<bitsize_t bitsize>
-	SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator=(const BigUint &num)
+	constexpr SelectType<bitsize_t>::BigUint<bitsize> &SelectType<bitsize_t>::BigUint<bitsize>::operator=(const BigUint &num) noexcept
 	{
-		// assign non-leading-zero elements of the operator array
-		if(num.op_size <= op_size) {
-			for(bitsize_t i=0;i<num.op_size;i++) op[i] = num.op[i];
-			for(bitsize_t i=num.op_size;i<op_size;i++) op[i] = num.op[i]; // op_size is bigger than num.op_size, pad op
-		} else {
-			for(bitsize_t i=0;i<op_size;i++) op[i] = num.op[i]; // num.op won't fit in op
-		}
+		op = num.op;
+		op_nonleading_i = num.op_nonleading_i;
 		return *this;
 	}
 
 	// copy constructor
 	template<typename bitsize_t>
 	template<bitsize_t bitsize>
-	SelectType<bitsize_t>::BigUint<bitsize>::BigUint(const BigUint &num)
+	constexpr SelectType<bitsize_t>::BigUint<bitsize>::BigUint(const BigUint &num) noexcept : op(num.op), op_nonleading_i(num.op_nonleading_i) {}
+
+	// move assignment operator
+	template<typename bitsize_t>
+	template<bitsize_t bitsize>
+	constexpr SelectType<bitsize_t>::BigUint<bitsize> &SelectType<bitsize_t>::BigUint<bitsize>::operator=(BigUint &&num) noexcept
 	{
-		// assign non-leading-zero elements of the operator array
-		if(num.op_size <= op_size) {
-			for(bitsize_t i=0;i<num.op_size;i++) op[i] = num.op[i];
-			for(bitsize_t i=num.op_size;i<op_size;i++) op[i] = num.op[i]; // op_size is bigger than num.op_size, pad op
-		} else {
-			for(bitsize_t i=0;i<op_size;i++) op[i] = num.op[i]; // num.op won't fit in op
-		}
+		op = num.op;
+		op_nonleading_i = num.op_nonleading_i;
+		return *this;
 	}
+
+	// move constructor
+	template<typename bitsize_t>
+	template<bitsize_t bitsize>
+	constexpr SelectType<bitsize_t>::BigUint<bitsize>::BigUint(BigUint &&num) noexcept : op(num.op), op_nonleading_i(num.op_nonleading_i) {}
 	
 	template<typename bitsize_t>
 	template<bitsize_t bitsize>
@@ -219,7 +222,7 @@ namespace BigInt
 	[[nodiscard("discarded BigUint boolean and operator&&")]]
 	constexpr bool SelectType<bitsize_t>::BigUint<bitsize>::operator&&(BigUint num) const
 	{
-		if (*this == "0" or num == "0") return 0;
+		if (is_zero() or num.is_zero()) return 0;
 		return 1;
 	}
 	
@@ -228,7 +231,7 @@ namespace BigInt
 	[[nodiscard("discarded BigUint boolean or operator||")]]
 	constexpr bool SelectType<bitsize_t>::BigUint<bitsize>::operator||(BigUint num) const
 	{
-		if (*this == "0" and num == "0") return 0;
+		if (is_zero() and num.is_zero()) return 0;
 		return 1;
 	}
 	
@@ -239,29 +242,78 @@ namespace BigInt
 	[[nodiscard("discarded BigUint boolean equal to operator==")]]
 	constexpr bool SelectType<bitsize_t>::BigUint<bitsize>::operator==(const BigUint &num) const
 	{
-		bool equal = 0;
-		for(bitsize_t i=0;i<op_size;i++) {
-			equal = op[i] == num.op[i];
-			if (!equal) return 0;
-		}
-		return equal;
+		return cmp(num) == 0;
 	}
 	#pragma GCC diagnostic pop
 	
-	// check if initialized and not zero
+	// check if zero
 	template<typename bitsize_t>
 	template<bitsize_t bitsize>
 	[[nodiscard("discarded BigUint boolean not operator!")]]
 	constexpr bool SelectType<bitsize_t>::BigUint<bitsize>::operator!() const
 	{
-		bool notzero = 0;
-		for(bitsize_t i=0;i<op_size;i++) {
-			if(op[i] != 0) {
-				notzero = 1;
-				break;
-			}
+		return is_zero();
+	}
+
+	template<typename bitsize_t>
+	template<bitsize_t bitsize>
+	constexpr bool SelectType<bitsize_t>::BigUint<bitsize>::is_zero() const noexcept
+	{
+		uint64_t any = 0;
+		for(bitsize_t i=op_nonleading_i;i<op_size;i++) any |= op[i];
+		return any == 0;
+	}
+
+	template<typename bitsize_t>
+	template<bitsize_t bitsize>
+	constexpr bool SelectType<bitsize_t>::BigUint<bitsize>::is_one() const noexcept
+	{
+		return cmp(1) == 0;
+	}
+
+	template<typename bitsize_t>
+	template<bitsize_t bitsize>
+	constexpr bool SelectType<bitsize_t>::BigUint<bitsize>::is_odd() const noexcept
+	{
+		return op[op_size-1] & 1;
+	}
+
+	template<typename bitsize_t>
+	template<bitsize_t bitsize>
+	constexpr int SelectType<bitsize_t>::BigUint<bitsize>::cmp(uint64_t num) const noexcept
+	{
+		for(bitsize_t i=op_nonleading_i;i<op_size-1;i++) {
+			if(op[i] != 0) return 1; // any higher limb makes it larger than a 64-bit value
 		}
-		return notzero;
+		const uint64_t low = op[op_size-1];
+		return low < num ? -1 : low > num;
+	}
+
+	template<typename bitsize_t>
+	template<bitsize_t bitsize>
+	constexpr int SelectType<bitsize_t>::BigUint<bitsize>::cmp(const BigUint &num) const noexcept
+	{
+		const bitsize_t start = std::min(op_nonleading_i, num.op_nonleading_i);
+		return limb::cmp(op.data()+start, num.op.data()+start, op_size-start);
+	}
+
+	template<typename bitsize_t>
+	template<bitsize_t bitsize>
+	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::from_bytes(std::span<const std::byte> bytes)
+	{
+		BigUint ret = 0;
+		if(!limb::set_bytes(ret.op.data(), op_size, bytes.data(), bytes.size()))
+			throw int_too_large_error("byte string is too large for the BigUint");
+		ret.normalize_from(0);
+		return ret;
+	}
+
+	template<typename bitsize_t>
+	template<bitsize_t bitsize>
+	constexpr void SelectType<bitsize_t>::BigUint<bitsize>::to_bytes(std::span<std::byte> bytes) const
+	{
+		if(!limb::get_bytes(bytes.data(), bytes.size(), op.data(), op_size))
+			throw int_too_large_error("BigUint doesn't fit the byte string");
 	}
 
 	// boolean operator, check if not equal to
@@ -272,160 +324,64 @@ namespace BigInt
 	[[nodiscard("discarded BigUint boolean not equal to operator!=")]]
 	constexpr bool SelectType<bitsize_t>::BigUint<bitsize>::operator!=(const BigUint &num) const
 	{
-		bool notequal = 0;
-		for(bitsize_t i=0;i<op_size;i++) {
-			notequal |= op[i] != num.op[i];
-			if(notequal) return notequal;
-		}
-		return notequal;
+		return cmp(num) != 0;
 	}
 	#pragma GCC diagnostic pop
 
-	// TODO: make sure that all of the following comparision operators work with different op-sizes, they are currently not designed to.
-	
 	template<typename bitsize_t>
 	template<bitsize_t bitsize>
 	[[nodiscard("discarded BigUint boolean less than operator<")]]
 	constexpr bool SelectType<bitsize_t>::BigUint<bitsize>::operator<(const BigUint &num) const
 	{
-		bool less = 0;
-	
-		// condition to avoid iterating over non-existing members of op
-		const constexpr bitsize_t iterator = op_size < num.op_size ? op_size : num.op_size;
-		for(bitsize_t i=0;i<iterator;i++) {
-			if(op[i] < num.op[i]) {
-				less = 1;
-				break;
-			} else {
-				if(op[i] == num.op[i]) continue;
-				break;
-			}
-		}
-		return less;
+		return cmp(num) < 0;
 	}
-	
+
 	template<typename bitsize_t>
 	template<bitsize_t bitsize>
 	constexpr bool SelectType<bitsize_t>::BigUint<bitsize>::operator<=(const BigUint &num) const
 	{
-		bool less = 0; // or equal
-	
-		// condition to avoid iterating over non-existing members of op
-		const bitsize_t constexpr iterator = op_size < num.op_size ? op_size : num.op_size;
-		for(bitsize_t i=iterator;i --> 0;) {
-			if(op[i] <= num.op[i]) {
-				less = 1;
-				break;
-			} else {
-				break;
-			}
-		}
-		return less;
+		return cmp(num) <= 0;
 	}
-	
+
 	template<typename bitsize_t>
 	template<bitsize_t bitsize>
 	[[nodiscard("discarded BigUint greater operator>")]]
 	constexpr bool SelectType<bitsize_t>::BigUint<bitsize>::operator>(const BigUint &num) const
 	{
-		bool greater = 0; // or equal
-	
-		// condition to avoid iterating over non-existing members of op
-		const constexpr bitsize_t iterator = op_size < num.op_size ? op_size : num.op_size;
-		for(bitsize_t i=0;i<iterator;i++) {
-			if(op[i] > num.op[i]) {
-				greater = 1;
-				break;
-			} else {
-				if(op[i] == num.op[i]) continue;
-				break;
-			}
-		}
-		return greater;
+		return cmp(num) > 0;
 	}
-	
+
 	template<typename bitsize_t>
 	template<bitsize_t bitsize>
 	constexpr bool SelectType<bitsize_t>::BigUint<bitsize>::operator>=(const BigUint &num) const
 	{
-		bool greater = 0; // or equal
-	
-		// condition to avoid iterating over non-existing members of op
-		const constexpr bitsize_t iterator = op_size < num.op_size ? op_size : num.op_size;
-		for(bitsize_t i=iterator;i --> 0;) {
-			if(op[i] >= num.op[i]) {
-				greater = 1;
-				break;
-			} else {
-				break;
-			}
-		}
-		return greater;
+		return cmp(num) >= 0;
 	}
-	
+
 	
 	template<typename bitsize_t>
 	template<bitsize_t bitsize>
 	[[nodiscard("discarded BigUint operator+")]]
 	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator+(const BigUint &num)
 	{
-		uint64_t *new_op = (uint64_t*)calloc(8, op_size);
-		uint64_t *tmp_op = new uint64_t[op_size*8];
-		memcpy(tmp_op, op, 8*op_size); // if ptr: set to op
-		//std::copy(std::begin(op), std::end(op), std::begin(tmp_op)); // if array: set to op
-		//for(bitsize_t i=0;i<op_size;i++) new_op[i] = 0; // for debugging valgrind error, initialize new_op to zero first
-		
-		for(bitsize_t i=op_size;i --> 0;) {
-			__uint128_t tmp = tmp_op[i];
-			tmp += num.op[i];
-			if(tmp > UINT64_MAX) {
-	    		new_op[i] += tmp & UINT64_MAX; // assign the main value to assign value with no carry (only no carry because of bit-shifting)
-				bitsize_t j = 1;
-				if(j <= i) {
-					while(new_op[i-j] == UINT64_MAX) {
-	    				tmp_op[i-j]++; // carry
-						j++;
-					}
-	    			tmp_op[i-j]++;
-				}
-			} else {
-				new_op[i] += tmp;
-			}
-		}
-	
-		auto newint = BigUint<bitsize>(new_op, op_size);
-		delete[] tmp_op;
-		free(new_op);
-		return newint;
+		// limbs above both operands are zero, so the sum starts at the longer one and the carry can add one limb
+		const bitsize_t start = std::min(op_nonleading_i, num.op_nonleading_i);
+		BigUint<bitsize> ret;
+		const uint64_t carry = limb::add_n(ret.op.data()+start, op.data()+start, num.op.data()+start, op_size-start);
+		std::fill(ret.op.begin(), ret.op.begin()+start, 0);
+		if(carry != 0 && start != 0) ret.op[start-1] = carry; // otherwise the carry out of the top limb wraps around
+		ret.normalize_from(start == 0 ? 0 : start-1);
+		return ret;
 	}
 
 	template<typename bitsize_t>
 	template<bitsize_t bitsize>
 	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator+=(const BigUint &num)
 	{
-		uint64_t *tmp_op = new uint64_t[op_size];
-		//uint64_t tmp_op[op_size];
-		memcpy(tmp_op, op, op_size*8); // if ptr: set to op
-		// std::copy(std::begin(op), std::end(op), std::begin(tmp_op)); // if array: set to op
-		for(bitsize_t i=op_size;i --> 0;) {
-			op[i] = 0;
-			__uint128_t tmp = tmp_op[i];
-			tmp += num.op[i];
-			if(tmp > UINT64_MAX) {
-	    		op[i] = tmp & UINT64_MAX; // assign the main value to assign value with no carry (only no carry because of bit-shifting)
-				bitsize_t j = 1;
-				if(j <= i) {
-					while(op[i-j] == UINT64_MAX) { // carry index
-	    				tmp_op[i-j]++; // carry
-						j++;
-					}
-	    			tmp_op[i-j]++; // carry
-				}
-			} else {
-				op[i] += tmp;
-			}
-		}
-		delete[] tmp_op;
+		const bitsize_t start = std::min(op_nonleading_i, num.op_nonleading_i);
+		const uint64_t carry = limb::add_n(op.data()+start, op.data()+start, num.op.data()+start, op_size-start);
+		if(carry != 0 && start != 0) op[start-1] = carry;
+		normalize_from(start == 0 ? 0 : start-1);
 		return *this;
 	}
 
@@ -434,119 +390,152 @@ namespace BigInt
 	[[nodiscard("discarded BigUint operator-")]]
 	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator-(const BigUint &num)
 	{
-		uint64_t *ret = new uint64_t[op_size];
-		uint64_t *new_op = new uint64_t[op_size];
-		memcpy(new_op, op, op_size*8); // if ptr: set to op
-		// std::copy(std::begin(op), std::end(op), std::begin(new_op)); // if array: set to op
-		for(bitsize_t i=op_size;i --> 0;) {
-			ret[i] = 0;
-			if (new_op[i] < num.op[i]) {
-				ret[i] = new_op[i]-num.op[i];
-				bitsize_t j=1;
-				while(i-j > 0 and new_op[i-j] == 0) {
-					new_op[i-j]--; // carry
-					j++;
-				}
-				new_op[i-j]--;
-			} else {
-				ret[i] = new_op[i] - num.op[i];
-			}
-		}
-		auto newint = BigUint<bitsize>(ret, op_size);
-		delete[] new_op;
-		delete[] ret;
-		return newint;
+		// a borrow out of the significant limbs wraps around through the leading zeros
+		const bitsize_t start = std::min(op_nonleading_i, num.op_nonleading_i);
+		BigUint<bitsize> ret;
+		const uint64_t borrow = limb::sub_n(ret.op.data()+start, op.data()+start, num.op.data()+start, op_size-start);
+		std::fill(ret.op.begin(), ret.op.begin()+start, borrow != 0 ? ~uint64_t(0) : 0);
+		ret.normalize_from(borrow != 0 ? 0 : start);
+		return ret;
 	}
 
 	template<typename bitsize_t>
 	template<bitsize_t bitsize>
 	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator-=(const BigUint &num)
 	{
-		for(bitsize_t i=op_size;i --> 0;) {
-			if (op[i] < num.op[i]) {
-				op[i] -= num.op[i];
-				bitsize_t j=1;
-				while(i-j > 0 and op[i-j] == 0) {
-					op[i-j]--; // carry
-					j++;
-				}
-				op[i-j]--;
-			} else {
-				op[i] -= num.op[i];
-			}
-		}
+		const bitsize_t start = std::min(op_nonleading_i, num.op_nonleading_i);
+		const uint64_t borrow = limb::sub_n(op.data()+start, op.data()+start, num.op.data()+start, op_size-start);
+		if(borrow != 0) std::fill(op.begin(), op.begin()+start, ~uint64_t(0));
+		normalize_from(borrow != 0 ? 0 : start);
 		return *this;
 	}
 
 	template<typename bitsize_t>
 	template<bitsize_t bitsize>
 	[[nodiscard("discarded BigUint operator*")]]
-	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator*(BigUint num)
-	{
-		// Russian Peasant Algorithm
-		uint64_t *o = new uint64_t[op_size];
-		memcpy(o, op, 8*op_size); // for ptr
-		// for(bitsize_t i=0;i<op_size;i++) o[i] = op[i]; // for array
-		BigUint<bitsize> new_op = BigUint<bitsize>(o, op_size);
-		BigUint<bitsize> ret = 0;
-		while(num > "0") {
-			if(num & "1") ret += new_op;
-			new_op <<= 1; // try replacing with += new_op
-			num >>= 1; // try replacing with div
+	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator*(const BigUint &num)
+	{
+		// the product is truncated to op_size limbs like the other operators
+		if(&num == this) return sqr();
+		const bitsize_t an = limb_count(), bn = num.limb_count();
+		const uint64_t *a = op.data()+op_nonleading_i, *b = num.op.data()+num.op_nonleading_i;
+		BigUint<bitsize> ret;
+		if(an+bn <= op_size) { // the whole product fits, only the significant limbs are multiplied
+			const bitsize_t start = op_size-an-bn;
+			std::array<uint64_t, limb::mul_scratch_size_upto(op_size)> scratch;
+			std::fill(ret.op.begin(), ret.op.begin()+start, 0);
+			limb::mul(ret.op.data()+start, a, an, b, bn, scratch.data());
+			ret.normalize_from(start);
+		} else if(std::min(an, bn) < op_size/2) { // a short operand costs less than the truncated product
+			std::array<uint64_t, 2*op_size> wide;
+			std::array<uint64_t, limb::mul_scratch_size_upto(op_size)> scratch;
+			limb::mul(wide.data(), a, an, b, bn, scratch.data());
+			std::copy(wide.begin()+an+bn-op_size, wide.begin()+an+bn, ret.op.begin());
+			ret.normalize_from(0);
+		} else {
+			std::array<uint64_t, limb::mullo_n_scratch_size(op_size)> scratch;
+			limb::mullo_n(ret.op.data(), op.data(), num.op.data(), op_size, scratch.data());
+			ret.normalize_from(0);
 		}
-		delete[] o;
 		return ret;
 	}
 
 	template<typename bitsize_t>
 	template<bitsize_t bitsize>
-	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator*=(BigUint num)
+	template<bitsize_t n>
+	[[nodiscard("discarded BigUint mul_wide")]]
+	constexpr SelectType<bitsize_t>::BigUint<n> SelectType<bitsize_t>::BigUint<bitsize>::mul_wide(const BigUint &num) const
 	{
-		*this = *this * num;
-		return *this;
+		static_assert(n >= bitsize*2, "mul_wide result type can't hold the full product");
+		constexpr const bitsize_t new_op_size = BigUint<n>::__get_op_size();
+		constexpr const size_t wide_size = 2*size_t(op_size);
+
+		// significant limbs only, the limbs above the product are zero
+		const bitsize_t an = limb_count(), bn = num.limb_count();
+		std::array<uint64_t, wide_size> wide;
+		std::array<uint64_t, limb::mul_scratch_size_upto(op_size)> scratch;
+		std::fill(wide.begin(), wide.end()-an-bn, 0);
+		limb::mul(wide.data()+wide_size-an-bn, op.data()+op_nonleading_i, an, num.op.data()+num.op_nonleading_i, bn, scratch.data());
+
+		// wide can have one more limb than BigUint<n> when bitsize isn't a multiple of 64, that limb is always zero
+		BigUint<n> ret;
+		uint64_t *ret_op = ret.__get_op();
+		if constexpr(new_op_size >= wide_size) {
+			std::fill(ret_op, ret_op+new_op_size-wide_size, 0);
+			std::copy(wide.begin(), wide.end(), ret_op+new_op_size-wide_size);
+		} else {
+			std::copy(wide.end()-new_op_size, wide.end(), ret_op);
+		}
+		ret.normalize();
+		return ret;
 	}
 
 	template<typename bitsize_t>
 	template<bitsize_t bitsize>
-	[[nodiscard("discarded BigUint operator/")]]
-	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator/(const BigUint &num)
+	[[nodiscard("discarded BigUint sqr")]]
+	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::sqr() const
 	{
-			BigUint<bitsize> d = num;
-			BigUint<bitsize> current = 1;
-			BigUint<bitsize> ret = 0;
-
-			// make copy of *this
-			uint64_t *o = new uint64_t[op_size];
-			memcpy(o, op, 8*op_size);
-			// for(bitsize_t i=0;i<op_size;i++) o[i] = op[i];
-			BigUint<bitsize> new_op = BigUint<bitsize>(o, op_size);
-			delete[] o;
+		const bitsize_t an = limb_count();
+		const uint64_t *a = op.data()+op_nonleading_i;
+		std::array<uint64_t, limb::sqr_n_scratch_size_upto(op_size)> scratch;
+		BigUint<bitsize> ret;
+		if(2*an <= op_size) { // the whole square fits
+			const bitsize_t start = op_size-2*an;
+			std::fill(ret.op.begin(), ret.op.begin()+start, 0);
+			limb::sqr_n(ret.op.data()+start, a, an, scratch.data());
+			ret.normalize_from(start);
+		} else {
+			std::array<uint64_t, 2*op_size> wide;
+			limb::sqr_n(wide.data(), a, an, scratch.data());
+			std::copy(wide.begin()+2*an-op_size, wide.begin()+2*an, ret.op.begin());
+			ret.normalize_from(0);
+		}
+		return ret;
+	}
 
-			if (d > new_op) {
-				return 0;
-			}
+	template<typename bitsize_t>
+	template<bitsize_t bitsize>
+	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator*=(const BigUint &num)
+	{
+		*this = *this * num;
+		return *this;
+	}
 
-			if (d == new_op) {
-				return 1;
-			}
+	template<typename bitsize_t>
+	template<bitsize_t bitsize>
+	[[nodiscard("discarded BigUint divmod")]]
+	constexpr std::pair<typename SelectType<bitsize_t>::template BigUint<bitsize>, typename SelectType<bitsize_t>::template BigUint<bitsize>>
+	SelectType<bitsize_t>::BigUint<bitsize>::divmod(const BigUint &num) const
+	{
+		if(num.is_zero()) throw division_by_zero_error("BigUint division by zero");
 
-			while (d < new_op) {
-				d <<= 1;
-				current <<= 1;
-			}
+		// Knuth's Algorithm D, quotient and remainder come out of the same pass
+		// significant limbs only: the quotient has at most as many as *this, the remainder as many as num
+		const bitsize_t a_start = op_nonleading_i, b_start = num.op_nonleading_i;
+		BigUint<bitsize> q, r;
+		std::array<uint64_t, 2*op_size+1> scratch;
+		limb::divrem(q.op.data()+a_start, r.op.data()+b_start, op.data()+a_start, op_size-a_start, num.op.data()+b_start, op_size-b_start, scratch.data());
+		std::fill(q.op.begin(), q.op.begin()+a_start, 0);
+		std::fill(r.op.begin(), r.op.begin()+b_start, 0);
+		q.normalize_from(a_start);
+		r.normalize_from(b_start);
+		return {q, r};
+	}
 
-			d >>= 1;
-			current >>= 1;
+	template<typename bitsize_t>
+	template<bitsize_t bitsize>
+	[[nodiscard("discarded BigUint operator/")]]
+	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator/(const BigUint &num)
+	{
+		if(num.is_zero()) throw division_by_zero_error("BigUint division by zero");
 
-			while(current != "0") {
-				if(new_op > d) {
-					new_op -= d;
-					ret |= current;
-				}
-				current >>= 1;
-				d >>= 1;
-			}
-			return ret;
+		const bitsize_t a_start = op_nonleading_i, b_start = num.op_nonleading_i;
+		BigUint<bitsize> ret;
+		std::array<uint64_t, 2*op_size+1> scratch;
+		limb::divrem(ret.op.data()+a_start, nullptr, op.data()+a_start, op_size-a_start, num.op.data()+b_start, op_size-b_start, scratch.data());
+		std::fill(ret.op.begin(), ret.op.begin()+a_start, 0);
+		ret.normalize_from(a_start);
+		return ret;
 	}
 
 	template<typename bitsize_t>
@@ -562,7 +551,16 @@ namespace BigInt
 	[[nodiscard("discarded BigUint operator%")]]
 	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator%(const BigUint &num)
 	{
-		return *this - (*this / num) * num;
+		if(num.is_zero()) throw division_by_zero_error("BigUint division by zero");
+
+		// remainder only, the quotient digits aren't stored
+		const bitsize_t a_start = op_nonleading_i, b_start = num.op_nonleading_i;
+		BigUint<bitsize> ret;
+		std::array<uint64_t, 2*op_size+1> scratch;
+		limb::divrem(nullptr, ret.op.data()+b_start, op.data()+a_start, op_size-a_start, num.op.data()+b_start, op_size-b_start, scratch.data());
+		std::fill(ret.op.begin(), ret.op.begin()+b_start, 0);
+		ret.normalize_from(b_start);
+		return ret;
 	}
 
 	template<typename bitsize_t>
@@ -577,7 +575,10 @@ namespace BigInt
 	template<bitsize_t bitsize>
 	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator++(int)
 	{
-		*this += 1;
+		// the carry can only reach one limb above the significant ones
+		const bitsize_t start = op_nonleading_i == 0 ? 0 : op_nonleading_i-1;
+		limb::add_1(op.data()+start, op.data()+start, op_size-start, 1);
+		normalize_from(start);
 		return *this;
 	}
 
@@ -585,7 +586,13 @@ namespace BigInt
 	template<bitsize_t bitsize>
 	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator--(int)
 	{
-		*this -= 1;
+		const bitsize_t start = op_nonleading_i;
+		if(limb::sub_1(op.data()+start, op.data()+start, op_size-start, 1) != 0) { // zero wraps around to all ones
+			std::fill(op.begin(), op.begin()+start, ~uint64_t(0));
+			normalize_from(0);
+		} else {
+			normalize_from(start);
+		}
 		return *this;
 	}
 
@@ -607,11 +614,10 @@ namespace BigInt
 	[[nodiscard("discarded BigUint operator~")]]
 	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator~() const
 	{
-		uint64_t *ret = new uint64_t[op_size];
-		for(bitsize_t i=0;i<op_size;i++)  ret[i] = ~op[i];
-		auto newint = BigUint<bitsize>(ret, op_size);
-		delete[] ret;
-		return newint;
+		BigUint<bitsize> ret;
+		for(bitsize_t i=0;i<op_size;i++)  ret.op[i] = ~op[i];
+		ret.normalize_from(0);
+		return ret;
 	}
 
 	template<typename bitsize_t>
@@ -619,11 +625,13 @@ namespace BigInt
 	[[nodiscard("discarded BigUint operator&")]]
 	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator&(const BigUint &num)
 	{
-		uint64_t *ret = new uint64_t[op_size];
-		for(bitsize_t i=0;i<op_size;i++)  ret[i] = op[i] & num.op[i];
-		auto newint = BigUint<bitsize>(ret, op_size);
-		delete[] ret;
-		return newint;
+		// zero wherever either operand is
+		const bitsize_t start = std::max(op_nonleading_i, num.op_nonleading_i);
+		BigUint<bitsize> ret;
+		std::fill(ret.op.begin(), ret.op.begin()+start, 0);
+		for(bitsize_t i=start;i<op_size;i++)  ret.op[i] = op[i] & num.op[i];
+		ret.normalize_from(start);
+		return ret;
 	}
 
 	template<typename bitsize_t>
@@ -631,7 +639,10 @@ namespace BigInt
 	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator&=(const BigUint &num)
 	{
 		// assuming they are the same size. Which should be enforced by compiler by default
-		for(bitsize_t i=0;i<op_size;i++)  op[i] &= num.op[i];
+		const bitsize_t start = std::max(op_nonleading_i, num.op_nonleading_i);
+		std::fill(op.begin()+op_nonleading_i, op.begin()+start, 0);
+		for(bitsize_t i=start;i<op_size;i++)  op[i] &= num.op[i];
+		normalize_from(start);
 		return *this;
 	}
 
@@ -641,11 +652,12 @@ namespace BigInt
 	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator^(const BigUint &num)
 	{
 		// assuming they are the same size. Which should be enforced by compiler by default
-		uint64_t *ret = new uint64_t[op_size];
-		for(bitsize_t i=0;i<op_size;i++)  ret[i] = op[i] ^ num.op[i];
-		auto newint = BigUint<bitsize>(ret, op_size);
-		delete[] ret;
-		return newint;
+		const bitsize_t start = std::min(op_nonleading_i, num.op_nonleading_i);
+		BigUint<bitsize> ret;
+		std::fill(ret.op.begin(), ret.op.begin()+start, 0);
+		for(bitsize_t i=start;i<op_size;i++)  ret.op[i] = op[i] ^ num.op[i];
+		ret.normalize_from(start);
+		return ret;
 	}
 
 	template<typename bitsize_t>
@@ -653,7 +665,9 @@ namespace BigInt
 	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator^=(const BigUint &num)
 	{
 		// assuming they are the same size. Which should be enforced by compiler by default
-		for(bitsize_t i=0;i<op_size;i++)  op[i] ^= num.op[i];
+		const bitsize_t start = std::min(op_nonleading_i, num.op_nonleading_i);
+		for(bitsize_t i=start;i<op_size;i++)  op[i] ^= num.op[i];
+		normalize_from(start);
 		return *this;
 	}
 
@@ -662,68 +676,23 @@ namespace BigInt
 	[[nodiscard("discarded BigUint operator>>")]]
 	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator>>(const bitsize_t &num)
 	{
-		if(num >= bitsize) {
-			uint64_t *ret = (uint64_t*)calloc(8, op_size);
-			auto num = BigUint<bitsize>(ret, op_size);
-			free(ret);
-			return num;
-		}
-		uint64_t *ret = new uint64_t[op_size];
-		memcpy(ret, op, 8*op_size);
-
-		bitsize_t shift = num;
-		bitsize_t div = shift/64;
-		if(shift>=64) {
-		 	for(bitsize_t i=div;i<op_size;i++) ret[i] = op[i-div];
-		 	for(bitsize_t i=0;i<div;i++) ret[i] = 0;
-		}
-		shift %= 64;
-		if(shift != 0) {
-			for(bitsize_t i=div;i<op_size;i++) {
-				ret[i] >>= shift;
-				if(i != div) {
-					// hex((0x5520466034583347 >> 2) | ((0x2337616833<<62) & (2**64-1)))
-					// std::cout << std::endl << "solution:" << (uint64_t)(ret[i]  |  ( ((__uint128_t)op[i-1] << 62) & UINT64_MAX)) << std::endl;
-					ret[i] |= op[i-1] << (64-shift);
-				}
-			}
-		}
+		if(num >= bitsize) return BigUint<bitsize>(0);
+		const bitsize_t words = num/64, start = op_nonleading_i, n = op_size-start;
+		if(words >= n) return BigUint<bitsize>(0);
 
-		auto newint = BigUint<bitsize>(ret, op_size);
-		delete[] ret;
-		return newint;
+		// the significant limbs move down by words, the limbs above them are zero
+		BigUint<bitsize> ret;
+		std::fill(ret.op.begin(), ret.op.begin()+start+words, 0);
+		limb::rshift(ret.op.data()+start+words, op.data()+start, n-words, num%64);
+		ret.normalize_from(start+words);
+		return ret;
 	}
 
 	template<typename bitsize_t>
 	template<bitsize_t bitsize>
 	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator>>=(const bitsize_t &num)
 	{
-		if(num >= bitsize) {
-			for(bitsize_t i=0;i<op_size;i++) op[i] = 0;
-			return *this;
-		}
-
-		uint64_t *_copy = new uint64_t[op_size];
-		memcpy(_copy, op, 8*op_size);
-
-		bitsize_t shift = num;
-		bitsize_t div = shift/64;
-		if(shift>=64) {
-		 	for(bitsize_t i=div;i<op_size;i++) op[i] = op[i-div];
-		 	for(bitsize_t i=0;i<div;i++) op[i] = 0;
-		}
-
-		shift %= 64;
-		if(shift != 0) {
-			for(bitsize_t i=div;i<op_size;i++) {
-				op[i] >>= shift;
-				if(i != div) {
-					op[i] |= _copy[i-1] << (64-shift);
-				}
-			}
-		}
-
-		delete[] _copy;
+		*this = *this >> num;
 		return *this;
 	}
 
@@ -732,69 +701,29 @@ namespace BigInt
 	[[nodiscard("discarded BigUint operator<<")]]
 	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator<<(const bitsize_t &num)
 	{
-		if(num >= bitsize) {
-			uint64_t *ret = (uint64_t*)calloc(8, op_size);
-			auto num = BigUint<bitsize>(ret, op_size);
-			free(ret);
-			return num;
-		}
-		uint64_t *ret = new uint64_t[op_size];
-		memcpy(ret, op, 8*op_size);
-
-		bitsize_t shift = num;
-		bitsize_t div = shift/64;
-		bitsize_t ind = op_size-div;
-		if(shift>=64) {
-		 	for(bitsize_t i=0;i<ind;i++) ret[i] = ret[i+div];
-		 	for(bitsize_t i=ind;i<op_size;i++) ret[i] = 0;
-		}
-		shift %= 64;
-		if(shift != 0) {
-			for(bitsize_t i=0;i<ind;i++) {
-				__uint128_t tmp = (__uint128_t)ret[i] << shift;
-				if(tmp > UINT64_MAX and i != 0) { // move overflow to next index
-					ret[i-1] |= tmp >> 64;
-					ret[i] = tmp;
-				} else {
-					ret[i] = tmp;
-				}
-			}
-		}
+		if(num >= bitsize) return BigUint<bitsize>(0);
+		const bitsize_t words = num/64;
 
-		auto newint = BigUint<bitsize>(ret, op_size);
-		delete[] ret;
-		return newint;
+		// the low m significant limbs move up by words, the bits shifted out of them land in the limb above
+		const bitsize_t m = std::min<bitsize_t>(limb_count(), op_size-words), dst = op_size-words-m;
+		BigUint<bitsize> ret;
+		std::fill(ret.op.begin()+op_size-words, ret.op.end(), 0);
+		const uint64_t carry = limb::lshift(ret.op.data()+dst, op.data()+op_size-m, m, num%64);
+		if(dst == 0) { // the carry falls off the top
+			ret.normalize_from(0);
+			return ret;
+		}
+		std::fill(ret.op.begin(), ret.op.begin()+dst-1, 0);
+		ret.op[dst-1] = carry;
+		ret.normalize_from(dst-1);
+		return ret;
 	}
 
 	template<typename bitsize_t>
 	template<bitsize_t bitsize>
 	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator<<=(const bitsize_t &num)
 	{
-		if(num >= bitsize) {
-			for(bitsize_t i=0;i<op_size;i++) op[i] = 0;
-			return *this;
-		}
-
-		bitsize_t shift = num;
-		bitsize_t div = shift/64;
-		bitsize_t ind = op_size-div;
-		if(shift>=64) {
-		 	for(bitsize_t i=0;i<ind;i++) op[i] = op[i+div];
-		 	for(bitsize_t i=ind;i<op_size;i++) op[i] = 0;
-		}
-		shift %= 64;
-		if(shift != 0) {
-			for(bitsize_t i=0;i<ind;i++) {
-				__uint128_t tmp = (__uint128_t)op[i] << shift;
-				if(tmp > UINT64_MAX and i != 0) { // move overflow to next index
-					op[i-1] |= tmp >> 64;
-					op[i] = tmp;
-				} else {
-					op[i] = tmp;
-				}
-			}
-		}
-
+		*this = *this << num;
 		return *this;
 	}
 
@@ -805,11 +734,12 @@ namespace BigInt
 	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator|(const BigUint &num)
 	{
 		// assuming they are the same size. Which should be enforced by compiler by default
-		uint64_t *ret = new uint64_t[op_size];
-		for(bitsize_t i=0;i<op_size;i++)  ret[i] = op[i] | num.op[i];
-		auto newint = BigUint<bitsize>(ret, op_size);
-		delete[] ret;
-		return newint;
+		const bitsize_t start = std::min(op_nonleading_i, num.op_nonleading_i);
+		BigUint<bitsize> ret;
+		std::fill(ret.op.begin(), ret.op.begin()+start, 0);
+		for(bitsize_t i=start;i<op_size;i++)  ret.op[i] = op[i] | num.op[i];
+		ret.normalize_from(start);
+		return ret;
 	}
 
 	template<typename bitsize_t>
@@ -817,74 +747,110 @@ namespace BigInt
 	constexpr SelectType<bitsize_t>::BigUint<bitsize> SelectType<bitsize_t>::BigUint<bitsize>::operator|=(const BigUint &num)
 	{
 		// assuming they are the same size. Which should be enforced by compiler by default
-		for(bitsize_t i=0;i<op_size;i++)  op[i] |= num.op[i];
+		const bitsize_t start = std::min(op_nonleading_i, num.op_nonleading_i);
+		for(bitsize_t i=start;i<op_size;i++)  op[i] |= num.op[i];
+		normalize_from(start);
 		return *this;
 	}
 
-	template<uint16_t bitsize>
-	SelectType<uint16_t>::BigUint<bitsize> pow(SelectType<uint16_t>::BigUint<bitsize> base, SelectType<uint16_t>::BigUint<bitsize> exp)
+	// bits per digit of the power of two bases that from_chars and to_chars support, 0 for anything else
+	inline constexpr unsigned pow2_base_bits(int base)
 	{
+		return base == 16 ? 4 : base == 8 ? 3 : base == 2 ? 1 : 0;
+	}
 
-		SelectType<uint16_t>::BigUint<bitsize> ret = 1;
-		for(SelectType<uint16_t>::BigUint<bitsize> i=0;i<exp;i++) {
-			ret *= base;
+	template<typename uint_type>
+	constexpr std::from_chars_result from_chars(const char *first, const char *last, uint_type &value, int base)
+	{
+		constexpr const size_t op_size = uint_type::__get_op_size();
+		const unsigned bits = pow2_base_bits(base);
+		if(bits == 0 && base != 10) return {first, std::errc::invalid_argument};
+
+		const char *end = first;
+		while(end != last && limb::digit_values[(unsigned char)*end] < base) end++;
+		if(end == first) return {first, std::errc::invalid_argument};
+
+		uint_type parsed;
+		if(base == 10) {
+			std::array<uint64_t, decimal::scratch_size(op_size)> scratch;
+			if(!decimal::set_str(parsed.__get_op(), op_size, first, end-first, decimal::powers_for<op_size>(), scratch.data()))
+				return {end, std::errc::result_out_of_range};
+		} else if(!limb::set_str_pow2(parsed.__get_op(), op_size, first, end-first, bits)) {
+			return {end, std::errc::result_out_of_range};
 		}
-		return ret;
-		//BigUint<bitsize> q = exp;
-		//BigUint<bitsize> prod = 1;
-		//BigUint<bitsize> current = base;
-		//while(q > "0") {
-		//	if(q & "1") {
-		//		prod *= current;
-		//		q-=1;
-		//	}
-		//	current *= current;
-		//	q /= 2;
-		//}
-		//
-		//return prod;
+		parsed.normalize();
+		value = parsed;
+		return {end, std::errc()};
 	}
-	template<uint32_t bitsize>
-	SelectType<uint32_t>::BigUint<bitsize> pow(SelectType<uint32_t>::BigUint<bitsize> base, SelectType<uint32_t>::BigUint<bitsize> exp)
-	{
 
-		SelectType<uint32_t>::BigUint<bitsize> ret = 1;
-		for(SelectType<uint32_t>::BigUint<bitsize> i=0;i<exp;i++) {
-			ret *= base;
+	template<typename uint_type>
+	constexpr std::to_chars_result to_chars(char *first, char *last, const uint_type &value, int base)
+	{
+		constexpr const size_t op_size = uint_type::__get_op_size();
+		if(base == 10) {
+			// the length is only known after the conversion, so go through a stack buffer if the caller's might be short
+			std::array<uint64_t, decimal::scratch_size(op_size)> scratch;
+			constexpr const size_t digits = decimal::max_digits(64*op_size);
+			if(size_t(last-first) >= digits)
+				return {first+decimal::get_str(first, value.__get_op(), op_size, decimal::powers_for<op_size>(), scratch.data()), std::errc()};
+			std::array<char, digits> buffer;
+			const size_t len = decimal::get_str(buffer.data(), value.__get_op(), op_size, decimal::powers_for<op_size>(), scratch.data());
+			if(size_t(last-first) < len) return {last, std::errc::value_too_large};
+			return {std::copy(buffer.data(), buffer.data()+len, first), std::errc()};
 		}
-		return ret;
+		const unsigned bits = pow2_base_bits(base);
+		if(bits == 0) return {last, std::errc::invalid_argument};
+
+		const size_t len = limb::str_size_pow2(value.__get_op(), op_size, bits);
+		if(size_t(last-first) < len) return {last, std::errc::value_too_large};
+		return {first+limb::get_str_pow2(first, value.__get_op(), op_size, bits), std::errc()};
 	}
 
-	template<uint64_t bitsize>
-	SelectType<uint64_t>::BigUint<bitsize> pow(SelectType<uint64_t>::BigUint<bitsize> base, SelectType<uint64_t>::BigUint<bitsize> exp)
+	template<typename uint_type>
+	constexpr size_t max_chars(int base)
 	{
+		if(base == 10) return decimal::max_digits(uint_type::__get_op_size()*64);
+		const unsigned bits = pow2_base_bits(base);
+		return bits == 0 ? 0 : (uint_type::__get_op_size()*64+bits-1)/bits;
+	}
 
-		SelectType<uint64_t>::BigUint<bitsize> ret = 1;
-		for(SelectType<uint64_t>::BigUint<bitsize> i=0;i<exp;i++) {
-			ret *= base;
+	// left-to-right square and multiply, the result is truncated to the bitsize like operator*
+	template<typename uint_type>
+	constexpr uint_type pow_binary(uint_type base, const uint_type &exp)
+	{
+		constexpr const size_t op_size = uint_type::__get_op_size();
+		const uint64_t *e = exp.__get_op();
+		uint_type ret = 1;
+		for(size_t i=limb::bit_length(e, op_size);i --> 0;) {
+			ret = ret.sqr();
+			if((e[op_size-1-i/64] >> (i%64)) & 1) ret *= base;
 		}
 		return ret;
 	}
 
-	template<__uint128_t bitsize>
-	SelectType<__uint128_t>::BigUint<bitsize> pow(SelectType<__uint128_t>::BigUint<bitsize> base, SelectType<__uint128_t>::BigUint<bitsize> exp)
+	template<uint16_t bitsize>
+	SelectType<uint16_t>::BigUint<bitsize> pow(SelectType<uint16_t>::BigUint<bitsize> base, SelectType<uint16_t>::BigUint<bitsize> exp)
 	{
+		return pow_binary(base, exp);
+	}
 
-		SelectType<__uint128_t>::BigUint<bitsize> ret = 1;
-		for(SelectType<__uint128_t>::BigUint<bitsize> i=0;i<exp;i++) {
-			ret *= base;
-		}
-		return ret;
+	template<uint32_t bitsize>
+	SelectType<uint32_t>::BigUint<bitsize> pow(SelectType<uint32_t>::BigUint<bitsize> base, SelectType<uint32_t>::BigUint<bitsize> exp)
+	{
+		return pow_binary(base, exp);
 	}
 
-	// define destructor
-	template<typename bitsize_t>
-	template<bitsize_t bitsize>
-	SelectType<bitsize_t>::BigUint<bitsize>::~BigUint()
+	template<uint64_t bitsize>
+	SelectType<uint64_t>::BigUint<bitsize> pow(SelectType<uint64_t>::BigUint<bitsize> base, SelectType<uint64_t>::BigUint<bitsize> exp)
 	{
-		delete[] op;
+		return pow_binary(base, exp);
+	}
+
+	template<__uint128_t bitsize>
+	SelectType<__uint128_t>::BigUint<bitsize> pow(SelectType<__uint128_t>::BigUint<bitsize> base, SelectType<__uint128_t>::BigUint<bitsize> exp)
+	{
+		return pow_binary(base, exp);
 	}
-	
 
 	// use the following types.
 
@@ -903,6 +869,51 @@ namespace BigInt
 	// Use YugeUint when you need numbers in range (0, 2^170141183460469231731687303715884105728)
 	template<__uint128_t bitsize>
 	using YugeUint = SelectType<__uint128_t>::BigUint<bitsize>;
+
+	// compile-time literals, e.g. 0x1234_u2048 or 65537_u256. Bring them in with `using namespace BigInt::literals;`
+	namespace literals
+	{
+		// hex (0x), binary (0b), octal (leading 0) or decimal digits to limbs, ' separators are skipped.
+		// Invalid digits or a value that doesn't fit uint_type fail to compile
+		template<typename uint_type, char... chars>
+		consteval uint_type parse_literal()
+		{
+			constexpr const size_t op_size = uint_type::__get_op_size();
+			constexpr const char str[] = {chars..., '\0'};
+			size_t i = 0;
+			uint64_t base = 10;
+			if(str[0] == '0' && (str[1] == 'x' || str[1] == 'X')) base = 16, i = 2;
+			else if(str[0] == '0' && (str[1] == 'b' || str[1] == 'B')) base = 2, i = 2;
+			else if(str[0] == '0' && str[1] != '\0') base = 8, i = 1;
+
+			uint_type ret = 0;
+			uint64_t *op = ret.__get_op();
+			for(;str[i] != '\0';i++) {
+				const char c = str[i];
+				if(c == '\'') continue;
+				uint64_t digit;
+				if(c >= '0' && c <= '9') digit = c-'0';
+				else if(c >= 'a' && c <= 'f') digit = c-'a'+10;
+				else if(c >= 'A' && c <= 'F') digit = c-'A'+10;
+				else throw wrong_type_error("invalid digit in BigUint literal");
+				if(digit >= base) throw wrong_type_error("invalid digit in BigUint literal");
+
+				if(limb::mul_1(op, op, op_size, base) != 0 || limb::add_1(op, op, op_size, digit) != 0)
+					throw int_too_large_error("BigUint literal doesn't fit its type");
+			}
+			ret.normalize();
+			return ret;
+		}
+
+		template<char... chars> consteval BigUint<128> operator""_u128() { return parse_literal<BigUint<128>, chars...>(); }
+		template<char... chars> consteval BigUint<256> operator""_u256() { return parse_literal<BigUint<256>, chars...>(); }
+		template<char... chars> consteval BigUint<512> operator""_u512() { return parse_literal<BigUint<512>, chars...>(); }
+		template<char... chars> consteval BigUint<1024> operator""_u1024() { return parse_literal<BigUint<1024>, chars...>(); }
+		template<char... chars> consteval BigUint<2048> operator""_u2048() { return parse_literal<BigUint<2048>, chars...>(); }
+		template<char... chars> consteval BigUint<3072> operator""_u3072() { return parse_literal<BigUint<3072>, chars...>(); }
+		template<char... chars> consteval BigUint<4096> operator""_u4096() { return parse_literal<BigUint<4096>, chars...>(); }
+		template<char... chars> consteval BigUint<8192> operator""_u8192() { return parse_literal<BigUint<8192>, chars...>(); }
+	}; /* NAMESPACE LITERALS */
 }; /* NAMESPACE BIGINT */
 
 #endif /* BIGINT_CPP */
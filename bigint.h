@@ -12,6 +12,13 @@
 #include <type_traits>
 #include <iostream>
 #include <random>
+#include <utility>
+#include <charconv>
+#include <string_view>
+#include <span>
+
+#include "limb.h"
+#include "decimal.h"
 
 // To define operations for all types instead of just multiples of 64. Calculate 2**bitsize (in 64-bit segments), every 64-bit segment is the modulo instead of UINT64_MAX, meaning replace UINT64_MAX WITH 2**bitsize
 
@@ -26,6 +33,11 @@ namespace BigInt
 	class int_too_large_error : public std::runtime_error {
 		public: explicit int_too_large_error(const char *str) : std::runtime_error(str) {}
 	};
+
+	// raise when dividing by zero
+	class division_by_zero_error : public std::runtime_error {
+		public: explicit division_by_zero_error(const char *str) : std::runtime_error(str) {}
+	};
 	
 	
 	template<typename bitsize_t>
@@ -34,37 +46,34 @@ namespace BigInt
 		bool isptr = 0; // if stackoverflow, make sure to make op a ptr. Do this by assigning isptr to 1
 		// custom-size integer class
 		template<bitsize_t bitsize>
-		// alignas((bitsize%64==0 ? bitsize/64 : bitsize/64+1)<<3)
 		class BigUint {
 			protected:
 				// operator array
 				const constexpr static bitsize_t op_size = bitsize%64==0 ? bitsize/64 : bitsize/64+1;
-				uint64_t *op = new uint64_t[op_size];
-				//uint64_t op[op_size]; // when iterating, start from end to start
-				bitsize_t op_nonleading_i; // index of op when leading zeros end
+
+				// limbs are stored inline (no heap allocation per object). Aligned to a cache line so that the first limb never shares a line with another object
+				alignas(64) std::array<uint64_t, op_size> op; // when iterating, start from end to start
+				bitsize_t op_nonleading_i = 0; // every limb before this index is zero, operators only loop from here
 	
 				// uint128_t input to 2 uint64_t integers
 				// constant mask values
 			    static constexpr const __uint128_t bottom_mask_u128 = (__uint128_t{1} << 64) - 1; // 0x0000000000000000ffffffffffffffffU
 		    	static constexpr const __uint128_t top_mask_u128 = ~bottom_mask_u128;                  // 0xffffffffffffffff0000000000000000U
-	
-				// get substring of char* - helper function
-				constexpr std::string get_substring(const char* str, bitsize_t start, bitsize_t substrsize)
-				{
-					std::string substr = "";
-				
-					// Copy the characters from str[startIndex] to str[endIndex]
-					const bitsize_t width = substrsize+start;
-					for(bitsize_t i=start;i<width;i++) substr += str[i];
-					return substr;
-				}
-	
+
 			public:
 				#pragma GCC diagnostic push
 				#pragma GCC diagnostic ignored "-Wignored-qualifiers" // silence this warning, the qualifiers are necesarry
 				static const constexpr inline bitsize_t __get_op_size() { return op_size; }
 				#pragma GCC diagnostic pop
-				inline uint64_t* __get_op() { return op; }
+				// writable limbs: any limb can change, so the significant length goes back to op_size until normalize()
+				inline constexpr uint64_t* __get_op() { op_nonleading_i = 0; return op.data(); }
+				inline constexpr const uint64_t* __get_op() const { return op.data(); }
+
+				// upper bound on the significant limbs, every limb above them is zero
+				inline constexpr bitsize_t limb_count() const noexcept { return op_size-op_nonleading_i; }
+
+				// recompute the significant length after writing limbs through __get_op()
+				constexpr void normalize() noexcept { normalize_from(0); }
 		
 				const constexpr static bitsize_t size = bitsize;
 				template<uint8_t base=0> // type of input (int = base 10, hex = base 16)
@@ -76,8 +85,8 @@ namespace BigInt
 				template<bitsize_t len, std::array<uint64_t, len> tmp_op>
 				consteval BigUint assign_op() noexcept;
 
-				// destructor
-				~BigUint();
+				// destructor, nothing to free since op is stored inline
+				constexpr ~BigUint() = default;
 	
 				// the next constructor as a compile-time function
 				template<typename ...Ts>
@@ -90,6 +99,7 @@ namespace BigInt
 				constexpr BigUint(const uint64_t num) {
 					for(bitsize_t i=0;i<op_size-1;i++) op[i] = 0;
 					op[op_size-1] = num;
+					op_nonleading_i = op_size-1;
 				}
 		
 				// input as operation array
@@ -99,8 +109,12 @@ namespace BigInt
 				inline constexpr BigUint() noexcept = default;
 		
 				// assign uint256 to another uint256
-				BigUint operator=(const BigUint &num);
-				BigUint(const BigUint &num);
+				constexpr BigUint &operator=(const BigUint &num) noexcept;
+				constexpr BigUint(const BigUint &num) noexcept;
+
+				// move, op is inline so this is a plain copy of the limbs without any allocation
+				constexpr BigUint &operator=(BigUint &&num) noexcept;
+				constexpr BigUint(BigUint &&num) noexcept;
 				constexpr BigUint operator=(const char *&num);
 		
 				// arithmetic operations
@@ -108,12 +122,22 @@ namespace BigInt
 				constexpr BigUint operator+=(const BigUint &num);
 				constexpr BigUint operator-(const BigUint &num);
 				constexpr BigUint operator-=(const BigUint &num);
-				constexpr BigUint operator*(BigUint num);
-				constexpr BigUint operator*=(BigUint num);
+				constexpr BigUint operator*(const BigUint &num);
+				constexpr BigUint operator*=(const BigUint &num);
+
+				// full double-width product, nothing is truncated. n has to be at least bitsize*2
+				template<bitsize_t n=bitsize*2>
+				constexpr BigUint<n> mul_wide(const BigUint &num) const;
+
+				// *this * *this truncated like operator*, with the squaring kernels that compute every cross product once
+				constexpr BigUint sqr() const;
 				constexpr BigUint operator/(const BigUint &num);
 				constexpr BigUint operator/=(const BigUint &num);
 				constexpr BigUint operator%(const BigUint &num);
 				constexpr BigUint operator%=(const BigUint &num);
+
+				// quotient and remainder from one long division, {*this/num, *this%num}
+				constexpr std::pair<BigUint, BigUint> divmod(const BigUint &num) const;
 	
 				constexpr BigUint operator++(int);
 				constexpr BigUint operator--(int);
@@ -145,14 +169,31 @@ namespace BigInt
 				constexpr bool operator<=(const BigUint &num) const;
 				constexpr bool operator>(const BigUint &num) const;
 				constexpr bool operator>=(const BigUint &num) const;
+
+				// checks against small constants, nothing is constructed or parsed
+				constexpr bool is_zero() const noexcept;
+				constexpr bool is_one() const noexcept;
+				constexpr bool is_odd() const noexcept;
+
+				// compare with a 64-bit value, returns -1, 0 or 1
+				constexpr int cmp(uint64_t num) const noexcept;
+
+				// compare with another BigUint, returns -1, 0 or 1. Limbs above both significant lengths aren't read
+				constexpr int cmp(const BigUint &num) const noexcept;
+
+				// big-endian byte strings of any length (OS2IP), leading zero bytes are skipped. Raises int_too_large_error if it doesn't fit
+				constexpr static BigUint from_bytes(std::span<const std::byte> bytes);
+
+				// exactly bytes.size() big-endian bytes, zero padded (I2OSP). Raises int_too_large_error if the number needs more
+				constexpr void to_bytes(std::span<std::byte> bytes) const;
 				
 				// delete operators for deleting run-time objects
 				inline void operator delete(void *dat); // delete object itself
 		
-				inline constexpr operator uint64_t*() noexcept { return op; }
+				inline constexpr operator uint64_t*() noexcept { return __get_op(); }
 	
 				constexpr operator bool() noexcept {
-					return *this != "0";
+					return !is_zero();
 				}
 	
 				constexpr operator uint64_t() noexcept {
@@ -182,41 +223,50 @@ namespace BigInt
 					return op[0];
 				}
 
+				// base of the stream's basefield: hex, oct or decimal
+				template<typename stream_type>
+				static int stream_base(stream_type &ss)
+				{
+					const std::ios_base::fmtflags fmt = ss.flags() & std::ios_base::basefield;
+					if(fmt == std::ios_base::oct) return 8;
+					if(fmt == std::ios_base::hex) return 16;
+					return 10; // dec, also the default of a new stream
+				}
+
 				template<typename stringstream_type> // stringstream or ostringstream
-				void to_ostringstream(stringstream_type &ss)
+				void to_ostringstream(stringstream_type &ss) const
 				{
-					bool pad_stopped = 0; // if pad stopped, then print the rest, including zero values
-					bool last_num = 0;
-					uint8_t pad_size;
-				
-					// initialize the pad sizes based on whether the ostream is dec, hex, oct, bin.
-					std::ios_base::fmtflags fmt = ss.flags();
-					if(fmt & std::ios_base::dec) { // not supported
-						pad_size = 16;
-						ss << std::hex;
-					} else if(fmt & std::ios_base::hex) pad_size = 16; // pad count: 2^64-1=16 base 16 digits
-					else if(fmt & std::ios_base::oct) pad_size = 22;
+					// format into a stack buffer, the string_view keeps the stream's width and fill
+					std::array<char, op_size*22> buffer; // 22 octal digits per limb, more than the 20 decimal ones
+					const std::to_chars_result res = to_chars(buffer.data(), buffer.data()+buffer.size(), *this, stream_base(ss));
+					ss << std::string_view(buffer.data(), res.ptr);
+				}
 
-					for(uint16_t i=0;i<op_size;i++) {
-						if(op[i] != 0x0000000000000000ULL) pad_stopped=1;
-						if(pad_stopped) {
-							if(last_num)
-								ss << std::setfill('0') << std::setw(pad_size) << op[i];
-							else
-								ss << op[i]; // no padding
-							last_num = 1; // if not first print, pad
-						}
-					}
-					if(!pad_stopped) // if zero
-						ss << "0";
+				// reads one word in the stream's base, so what to_ostringstream wrote comes back unchanged
+				template<typename stringstream_type> // stringstream or istream
+				void from_istringstream(stringstream_type &ss)
+				{
+					std::string num;
+					ss >> num;
+					*this = from_string(num, stream_base(ss));
+				}
+
+				// input in base 8, 10 or 16 with the checks and errors of the string constructors, which always read hex
+				static BigUint from_string(const std::string &input, int base = 16)
+				{
+					BigUint ret;
+					if(base == 8) ret.strtobigint<8>(input.c_str());
+					else if(base == 10) ret.strtobigint<10>(input.c_str());
+					else ret.strtobigint<16>(input.c_str());
+					return ret;
 				}
 	
 				// string conversion
-				operator std::string()
+				operator std::string() const
 				{
-					std::ostringstream ss;
-					to_ostringstream<std::ostringstream>(ss);
-					return ss.str();
+					std::array<char, op_size*16> buffer;
+					const std::to_chars_result res = to_chars(buffer.data(), buffer.data()+buffer.size(), *this, 16);
+					return std::string(buffer.data(), res.ptr);
 				}
 	
 				// convert between different bigints
@@ -224,7 +274,7 @@ namespace BigInt
 				inline constexpr BigUint<n> to()
 				{
 					const constexpr bitsize_t new_op_size = n%64==0 ? n/64 : n/64+1;
-					uint64_t *num = new uint64_t[new_op_size];
+					std::array<uint64_t, new_op_size> num;
 					if constexpr(new_op_size <= op_size) { // when converting to a smaller type
 						const constexpr bitsize_t diff = op_size-new_op_size;
 						for(bitsize_t i=new_op_size;i --> 0;) num[i] = op[i+diff]; // smallest numbers of op will be dismissed, the major segment numbers will be in num
@@ -235,163 +285,60 @@ namespace BigInt
 							num[i] = 0;
 						}
 					}
-					auto new_obj = BigUint<n>(num, new_op_size);
-					delete[] num;
-					return new_obj;
+					return BigUint<n>(num.data(), new_op_size);
 				}
 
 		
-				template<bitsize_t n> friend std::ostream& operator<<(std::ostream& cout, BigUint<n> toprint);
+				template<bitsize_t n> friend std::ostream& operator<<(std::ostream& cout, const BigUint<n> &toprint);
 
-				// generate random number in range(from, to)
+				// generate random number in range(from, to), both included
 				// error is true if wrong range
-				#pragma GCC diagnostic push
-				#pragma GCC diagnostic ignored "-Wconversion-null"
 				constexpr static BigUint random(BigUint from, BigUint to, bool &error) // give range of numbers
 				{
-        			std::random_device randdev;
-        			std::mt19937 generator(randdev() ^ time(NULL));
-					
 					// if range is wrong
 					if(from > to) {
-						//BigUint swapper = from;
-						//from = to;
-						//to = swapper;
 						error=1; // wrong range error
-						return NULL;
-					}
-
-					// check if random number is in range of UINT64_MAX
-					bool u64_range=true;
-					bitsize_t from_size = (uint64_t)from == 0 ? 0 : 1; // to_size is the uint64-bit size without padding
-					bitsize_t to_size = (uint64_t)to == 0 ? 0 : 1; // to_size is the uint64-bit size without padding
-					if (from_size || to_size) {
-						for(bitsize_t i=op_size;i --> 0;) {
-							if(to.__get_op()[i] != 0) {
-								if(u64_range) to_size = i;
-								if(i != op_size-1) u64_range=false;
-							}
-							if(from.__get_op()[i] != 0) {
-								from_size = i;
-								if(!u64_range) break;
-							}
-						}
-					} else {
-						if(to_size == 0) return "0";
-					}
-					to_size = op_size-to_size;
-					from_size = op_size-from_size;
-
-					// random length between op_size and to_size, the length of random data in 64-bit segments
-					bitsize_t rand_len = std::uniform_int_distribution<bitsize_t>(from_size, to_size)(generator);
-					rand_len = 2;
-
-					// if to < UINT64_MAX
-					if (u64_range || rand_len==1)
-							return std::uniform_int_distribution<uint64_t>(from.__get_op()[op_size-1], to.__get_op()[op_size-1])(generator);
-
-        			std::uniform_int_distribution<uint64_t>
-        			                             distr_64(0, UINT64_MAX);
-					uint64_t *num = new uint64_t[op_size];
-					for(bitsize_t i=0;i<rand_len;i++) { // set to zero if not in range of to
-						num[i] = 0x0000000000000000ULL;
-					}
-					for(bitsize_t i=op_size;i --> rand_len+1;) {
-						num[i] = distr_64(generator);
+						return 0;
 					}
-					num[rand_len] = std::uniform_int_distribution<uint64_t>(from, to)(generator);
-
-					BigUint random_uint = BigUint(num, op_size);
-					delete[] num;
-					return random_uint;
+					return from + random(to - from);
 				}
-				#pragma GCC diagnostic pop
 
-				// generate random number up to to
+				// generate random number up to to, uniform in [0, to]. Limbs come straight from std::random_device,
+				// so the result can be used for key material
 				constexpr static BigUint random(BigUint to)
 				{
-        			std::random_device randdev;
-        			std::mt19937 generator(randdev() ^ time(NULL));
-
-					// check if random number is in range of UINT64_MAX
-					bool u64_range=true;
-					bitsize_t to_size = (uint64_t)to == 0 ? 0 : 1; // to_size is the uint64-bit size without padding
-					if(to_size) {
-						for(bitsize_t i=op_size-1;i --> 0;) {
-							if(to.__get_op()[i] != 0) {
-								u64_range=false;
-								to_size = i;
-								break;
-							}
-						}
-						to_size = op_size-to_size;
-					} else {
-						return "0";
-					}
-
-					// random length between from_size and to_size, the length of random data in 64-bit segments
-					bitsize_t rand_len = std::uniform_int_distribution<bitsize_t>(1, to_size)(generator);
-
-					// if to < UINT64_MAX
-					if (u64_range || rand_len==1)
-							return std::uniform_int_distribution<uint64_t>(0, to.__get_op()[op_size-1])(generator);
-
-
-    				std::uniform_int_distribution<uint64_t>
-    				                             distr_64(0, UINT64_MAX);
-					uint64_t *num = new uint64_t[op_size];
-					for(bitsize_t i=0;i<rand_len;i++) { // set to zero if not in range of to
-						num[i] = 0x0000000000000000ULL;
-					}
-					for(bitsize_t i=op_size;i --> rand_len+1;) {
-						num[i] = distr_64(generator);
-					}
-					num[rand_len] = std::uniform_int_distribution<uint64_t>(0, to)(generator);
-					BigUint random_uint = BigUint(num, op_size);
-					delete[] num;
-					return random_uint;
+					std::random_device randdev;
+					const size_t bits = limb::bit_length(to.op.data(), op_size);
+					if(bits == 0) return 0;
+
+					// random bits up to the length of to, drawn again while above to (less than half of the time)
+					const bitsize_t len = (bits+63)/64;
+					BigUint ret;
+					do {
+						std::fill(ret.op.begin(), ret.op.end()-len, 0);
+						for(bitsize_t i=op_size-len;i<op_size;i++) ret.op[i] = uint64_t(randdev()) << 32 | randdev();
+						ret.op[op_size-len] &= UINT64_MAX >> (64*len-bits);
+						ret.normalize_from(op_size-len);
+					} while(ret > to);
+					return ret;
 				}
 
 				// this print is for when stackoverflow error stops operator<<
-				void print()
+				void print() const
 				{
-					bool pad_stopped = 0; // if pad stopped, then print the rest, including zero values
-					bool last_num = 0;
-					uint8_t pad_size;
-				
-					// initialize the pad sizes based on whether the ostream is dec, hex, oct, bin.
-					std::ios_base::fmtflags fmt = std::cout.flags();
-					if(fmt & std::ios_base::dec) {
-						pad_size = 16;
-						std::cout << std::hex;
-					}
-					else if(fmt & std::ios_base::hex) pad_size = 16; // pad count: 2^64-1=16 base 16 digits
-					else if(fmt & std::ios_base::oct) pad_size = 22;
-					else pad_size = 64; // bin
-					for(uint16_t i=0;i<op_size;i++) {
-						if(op[i] != 0x0000000000000000ULL) pad_stopped=1;
-						if(pad_stopped) {
-							if(last_num)
-								std::cout << std::setfill('0') << std::setw(pad_size) << op[i];
-							else
-								std::cout << op[i]; // no padding
-							last_num = 1; // if not first print, pad
-						}
-					}
-					if(!pad_stopped) // if zero
-						std::cout << "0";
+					to_ostringstream(std::cout);
 				}
 
 				// log2
 				constexpr static BigUint log2(BigUint n)
 				{
-				    return (n > "1") ? BigUint(1) + log2(n >> bitsize_t(1)) : BigUint(0);
+				    return n.cmp(1) > 0 ? BigUint(1) + log2(n >> bitsize_t(1)) : BigUint(0);
 				}
 
 				// log2
 				constexpr BigUint log2()
 				{
-				    return (*this > "1") ? BigUint(1) + log2(*this >> bitsize_t(1)) : BigUint(0);
+				    return cmp(1) > 0 ? BigUint(1) + log2(*this >> bitsize_t(1)) : BigUint(0);
 				}
 
 				constexpr BigUint factorial()
@@ -403,6 +350,13 @@ namespace BigInt
 				}
 		
 			protected:
+				// op_nonleading_i = index of the first non-zero limb (op_size-1 for zero), every limb before from has to be zero
+				constexpr void normalize_from(bitsize_t from) noexcept
+				{
+					while(from < op_size-1 && op[from] == 0) from++;
+					op_nonleading_i = from;
+				}
+
 				constexpr bitsize_t nminussumofbits(bitsize_t v)
 				{
 					uint64_t w = v;
@@ -434,8 +388,7 @@ namespace BigInt
 				// remove 0x if starting with 0x
 				constexpr inline bool rm_trailhex(const char *&num, size_t &input_len)
 				{
-					std::string_view str(const_cast<char*>(num), 2);
-					if (str == "0x") {
+					if(input_len >= 2 && num[0] == '0' && (num[1] == 'x' || num[1] == 'X')) {
 						num += 2; // delete the 0x
 						input_len-=2;
 						return 1;
@@ -443,113 +396,65 @@ namespace BigInt
 					return 0;
 				} 
 		
-				// check if number is hex
+				// check if number is hex, one table lookup per character
 				constexpr bool is_hex(const char *num, size_t numlen)
 				{
-					for(size_t i=0;i<numlen;i++)
-						if(not isxdigit(*(num+i))) return 0;
-					return 1;
+					uint8_t invalid = 0;
+					for(size_t i=0;i<numlen;i++) invalid |= limb::digit_values[(unsigned char)num[i]] >> 4; // 0xff for non-digits
+					return numlen != 0 && invalid == 0;
 				}
 		
 				// check if input is base16
 				constexpr bool input_hex(const char *&input, size_t &input_len)
 				{
-					// check if input is hex
-					bool _is_hex = rm_trailhex(input, input_len); // remove trailing character if it exists
-					if(!_is_hex) { // if no hex trail character '0x'
-						_is_hex = is_hex(input, input_len); // check if input is hex
-						return _is_hex;
-					} else {
-						return 1;
-					}
+					rm_trailhex(input, input_len); // remove trailing character if it exists
+					return is_hex(input, input_len);
 				}
 		
-				// convert string to bigint
-				template<uint8_t base=0> // type of input (int = base 8, hex = base 16)
+				// convert string to bigint, parsed in place without temporary strings
+				template<uint8_t base=0> // type of input (oct = base 8, int = base 10, hex = base 16)
 				constexpr void strtobigint(const char *input)
 				{
-					constexpr const bool base8 = base==8;
-					constexpr const bool base16 = base==16;
 		   			size_t len = strlen(input);
-					// TODO: check if input length is in range of operator array length, if it's not generate error
-					constexpr const static __uint128_t hex_len_op = op_size*16;
-					constexpr const static __uint128_t oct_len_op = op_size*8;
-		
-					if constexpr(base16 or base8) {
-						if constexpr(base16) {
-							rm_trailhex(input); // remove trailing character if it exists
-							if(len >= hex_len_op) {
-								auto num = std::string(input).erase(hex_len_op, len-hex_len_op); // prune to hex_len_op
-								input = num.c_str();
-								len = strlen(input);
-							} // compare byte size
-							hexoct_to_bigint(input, len, 16);
-						} else { // base 8
-							if(len >= oct_len_op) {
-								auto num = std::string(input).erase(oct_len_op, len-oct_len_op); // prune to hex_len_op
-								input = num.c_str();
-								len = strlen(input);
-							} // compare byte size
-							hexoct_to_bigint(input, len, 8);
-						}
+					if constexpr(base == 8) {
+						const std::from_chars_result res = from_chars(input, input+len, *this, 8);
+						if(res.ec == std::errc::result_out_of_range) throw int_too_large_error("oct input is too large for the BigUint");
+						if(res.ec != std::errc() || res.ptr != input+len) throw wrong_type_error("string or const char* input has to be oct");
+					} else if constexpr(base == 10) {
+						const std::from_chars_result res = from_chars(input, input+len, *this, 10);
+						if(res.ec == std::errc::result_out_of_range) throw int_too_large_error("decimal input is too large for the BigUint");
+						if(res.ec != std::errc() || res.ptr != input+len) throw wrong_type_error("string or const char* input has to be decimal");
 					} else {
-		   				bool hex_input = input_hex(input, len);
-						if(hex_input) {
-							if(len >= hex_len_op) {
-								auto num = std::string(input).erase(hex_len_op, len-hex_len_op); // prune to hex_len_op
-								input = num.c_str();
-								len = strlen(input);
-								
-							} // compare byte size
-							hexoct_to_bigint(input, len, 16);
-						}
-						else throw wrong_type_error("string or const char* input has to be hex");
+						if(!input_hex(input, len)) throw wrong_type_error("string or const char* input has to be hex");
+						if(from_chars(input, input+len, *this, 16).ec != std::errc())
+							throw int_too_large_error("hex input is too large for the BigUint");
 					}
 				}
-				
-				// helper algorithm to convert hex or oct values to big integer
-				constexpr void hexoct_to_bigint(const char *input, bitsize_t len, const unsigned char part_size)
-				{
-		   			// convert oct/hex input to op elements
-		   			const uint8_t ind = len%part_size;
-		   			const bitsize_t multiple16_count = (len-ind)/part_size;
-					uint64_t *tmp;
-					if(multiple16_count != 0) {
-		   				tmp = new uint64_t[multiple16_count];
-						// get's the first multiple of part_size values of the integer
-		   				for(bitsize_t i=0;i<multiple16_count;i++) {
-							std::stringstream ss;
-							ss << std::hex << get_substring(input, i*part_size+ind,part_size);
-							ss >> tmp[i];
-						}
-		   			   	if(ind!=0) { // if len not a multiple of part_size
-		   			   		op_nonleading_i = op_size-multiple16_count-1; // includes the final value
-							std::stringstream ss;
-							ss << std::hex << get_substring(input, 0,ind);
-							ss >> op[op_size-multiple16_count-1];
-		   			   	 	for(bitsize_t i=multiple16_count+1;i --> 1;) op[op_size-i] = tmp[multiple16_count-i];
-		   			   	} else {
-		   			   		op_nonleading_i = op_size-multiple16_count; // if length is a multiple of part_size
-		   			   	 	for(bitsize_t i=multiple16_count+1;i --> 1;) op[op_size-i] = tmp[multiple16_count-i];
-		   			   	}
-					} else { // length < part_size
-		   				tmp = new uint64_t[1];
-						std::stringstream ss;
-						ss << std::hex << input;
-						ss >> *tmp;
-		   			   op_nonleading_i = op_size-1;
-					   op[op_nonleading_i] = *tmp;
-					}
-		   			// pad the operator array
-		   			for(bitsize_t i=0;i<op_nonleading_i;i++) op[i] = 0x0000000000000000ULL;
-		   			delete[] tmp;
-				}
 		};
 
 		template<bitsize_t bitsize>
 		BigUint<bitsize> pow(BigUint<bitsize> base, BigUint<bitsize> exp);
 		
 	};
+
+	// quotient and remainder of a/b for any BigUint type
+	template<typename uint_type>
+	constexpr std::pair<uint_type, uint_type> divmod(const uint_type &a, const uint_type &b) { return a.divmod(b); }
+
+	// hex (16), decimal (10), octal (8) or binary (2) digits in [first, last) to value like std::from_chars: no prefix or sign, the
+	// longest run of digits is parsed. value is only changed on success, ec is result_out_of_range if it doesn't fit. No allocation,
+	// except for the table of powers of 10 that is built on the first decimal conversion of a type
+	template<typename uint_type>
+	constexpr std::from_chars_result from_chars(const char *first, const char *last, uint_type &value, int base = 16);
+
+	// lowercase digits of value in base 16, 10, 8 or 2 to [first, last) without leading zeros like std::to_chars.
+	// ec is value_too_large if the buffer is too small
+	template<typename uint_type>
+	constexpr std::to_chars_result to_chars(char *first, char *last, const uint_type &value, int base = 16);
+
+	// longest to_chars output of uint_type in base, for sizing buffers
+	template<typename uint_type>
+	constexpr size_t max_chars(int base = 16);
 	//using uint192_t  = SelectType<uint16_t>::BigUint<192>; // remove until division algorithm works for non power of 2.
 	using uint256_t  = SelectType<uint16_t>::BigUint<256>;
 	//using uint384_t  = SelectType<uint16_t>::BigUint<384>; // remove until division algorithm works for non power of 2.
@@ -565,7 +470,7 @@ namespace BigInt
 
 	// stringstream
 	template<uint16_t bitsize>
-	std::stringstream& operator<<(std::stringstream& ss, selected_type16::BigUint<bitsize> num)
+	std::stringstream& operator<<(std::stringstream& ss, const selected_type16::BigUint<bitsize> &num)
 	{
 		num.to_ostringstream(ss);
 		return ss;
@@ -573,7 +478,7 @@ namespace BigInt
 	
 	// stringstream
 	template<uint32_t bitsize>
-	std::stringstream& operator<<(std::stringstream& ss, selected_type32::BigUint<bitsize> num)
+	std::stringstream& operator<<(std::stringstream& ss, const selected_type32::BigUint<bitsize> &num)
 	{
 		num.to_ostringstream(ss);
 		return ss;
@@ -581,7 +486,7 @@ namespace BigInt
 	
 	// stringstream
 	template<uint64_t bitsize>
-	std::stringstream& operator<<(std::stringstream& ss, selected_type64::BigUint<bitsize> num)
+	std::stringstream& operator<<(std::stringstream& ss, const selected_type64::BigUint<bitsize> &num)
 	{
 		num.to_ostringstream(ss);
 		return ss;
@@ -589,7 +494,7 @@ namespace BigInt
 	
 	// stringstream
 	template<__uint128_t bitsize>
-	std::stringstream& operator<<(std::stringstream& ss, selected_type128::BigUint<bitsize> num)
+	std::stringstream& operator<<(std::stringstream& ss, const selected_type128::BigUint<bitsize> &num)
 	{
 		num.to_ostringstream(ss);
 		return ss;
@@ -597,7 +502,7 @@ namespace BigInt
 
 	// output stream operator
 	template<uint16_t bitsize>
-	std::ostream& operator<<(std::ostream& cout, selected_type16::BigUint<bitsize> toprint)
+	std::ostream& operator<<(std::ostream& cout, const selected_type16::BigUint<bitsize> &toprint)
 	{
 		toprint.to_ostringstream(cout);
 		return cout;
@@ -605,7 +510,7 @@ namespace BigInt
 
 	// output stream operator
 	template<uint32_t bitsize>
-	std::ostream& operator<<(std::ostream& cout, selected_type32::BigUint<bitsize> toprint)
+	std::ostream& operator<<(std::ostream& cout, const selected_type32::BigUint<bitsize> &toprint)
 	{
 		toprint.to_ostringstream(cout);
 		return cout;
@@ -613,7 +518,7 @@ namespace BigInt
 	 
 	// output stream operator
 	template<uint64_t bitsize>
-	std::ostream& operator<<(std::ostream& cout, selected_type64::BigUint<bitsize> toprint)
+	std::ostream& operator<<(std::ostream& cout, const selected_type64::BigUint<bitsize> &toprint)
 	{
 		toprint.to_ostringstream(cout);
 		return cout;
@@ -621,7 +526,7 @@ namespace BigInt
 	 
 	// output stream operator
 	template<__uint128_t bitsize>
-	std::ostream& operator<<(std::ostream& cout, selected_type128::BigUint<bitsize> toprint)
+	std::ostream& operator<<(std::ostream& cout, const selected_type128::BigUint<bitsize> &toprint)
 	{
 		toprint.to_ostringstream(cout);
 		return cout;
@@ -632,9 +537,7 @@ namespace BigInt
 	template<uint16_t bitsize>
 	std::istream& operator>>(std::istream& cin, selected_type16::BigUint<bitsize> &input)
 	{
-		std::string num;
-		cin >> num;
-		input = num;
+		input.from_istringstream(cin);
 		return cin;
 	}
 
@@ -642,9 +545,7 @@ namespace BigInt
 	template<uint32_t bitsize>
 	std::istream& operator>>(std::istream& cin, selected_type32::BigUint<bitsize> &input)
 	{
-		std::string num;
-		cin >> num;
-		input = num;
+		input.from_istringstream(cin);
 		return cin;
 	}
 
@@ -652,9 +553,7 @@ namespace BigInt
 	template<uint64_t bitsize>
 	std::istream& operator>>(std::istream& cin, selected_type64::BigUint<bitsize> &input)
 	{
-		std::string num;
-		cin >> num;
-		input = num;
+		input.from_istringstream(cin);
 		return cin;
 	}
 
@@ -662,9 +561,7 @@ namespace BigInt
 	template<__uint128_t bitsize>
 	std::istream& operator>>(std::istream& cin, selected_type128::BigUint<bitsize> &input)
 	{
-		std::string num;
-		cin >> num;
-		input = num;
+		input.from_istringstream(cin);
 		return cin;
 	}
 
@@ -672,9 +569,7 @@ namespace BigInt
 	template<uint16_t bitsize>
 	std::stringstream& operator>>(std::stringstream& ss, selected_type16::BigUint<bitsize> &input)
 	{
-		std::string num;
-		ss >> num;
-		input = num;
+		input.from_istringstream(ss);
 		return ss;
 	}
 
@@ -682,9 +577,7 @@ namespace BigInt
 	template<uint32_t bitsize>
 	std::stringstream& operator>>(std::stringstream& ss, selected_type32::BigUint<bitsize> &input)
 	{
-		std::string num;
-		ss >> num;
-		input = num;
+		input.from_istringstream(ss);
 		return ss;
 	}
 
@@ -692,9 +585,7 @@ namespace BigInt
 	template<uint64_t bitsize>
 	std::stringstream& operator>>(std::stringstream& ss, selected_type64::BigUint<bitsize> &input)
 	{
-		std::string num;
-		ss >> num;
-		input = num;
+		input.from_istringstream(ss);
 		return ss;
 	}
 
@@ -702,9 +593,7 @@ namespace BigInt
 	template<__uint128_t bitsize>
 	std::stringstream& operator>>(std::stringstream& ss, selected_type128::BigUint<bitsize> &input)
 	{
-		std::string num;
-		ss >> num;
-		input = num;
+		input.from_istringstream(ss);
 		return ss;
 	}
 
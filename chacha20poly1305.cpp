@@ -0,0 +1,427 @@
+#ifndef CHACHA20POLY1305_CPP
+#define CHACHA20POLY1305_CPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <array>
+#include <span>
+#include <vector>
+#include <algorithm>
+
+#include "chacha20poly1305.h"
+
+namespace Aead
+{
+	namespace chacha
+	{
+		inline uint32_t load32(const std::byte *p)
+		{
+			uint32_t x;
+			std::memcpy(&x, p, 4);
+			return x; // little endian on every target the limb kernels support
+		}
+
+		inline uint64_t load64(const std::byte *p)
+		{
+			uint64_t x;
+			std::memcpy(&x, p, 8);
+			return x;
+		}
+
+		inline void store64(std::byte *p, uint64_t x)
+		{
+			std::memcpy(p, &x, 8);
+		}
+
+		// "expand 32-byte k", key, counter and nonce as 16 little endian words
+		inline std::array<uint32_t, 16> initial_state(const key_type &key, uint32_t counter, const nonce_type &nonce)
+		{
+			std::array<uint32_t, 16> s = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+			for(size_t i=0;i<8;i++) s[4+i] = load32(key.data()+4*i);
+			s[12] = counter;
+			for(size_t i=0;i<3;i++) s[13+i] = load32(nonce.data()+4*i);
+			return s;
+		}
+
+		// the same rounds for a single word or a vector with one block per lane. Vectors are updated in place and never
+		// passed by value, so the AVX2 instantiation keeps the ABI of its callers
+		template<typename word_type>
+		[[gnu::always_inline]] inline void rotl(word_type &x, int n)
+		{
+			x = (x << n) | (x >> (32-n));
+		}
+
+		template<typename word_type>
+		[[gnu::always_inline]] inline void quarter_round(word_type &a, word_type &b, word_type &c, word_type &d)
+		{
+			a += b; d ^= a; rotl(d, 16);
+			c += d; b ^= c; rotl(b, 12);
+			a += b; d ^= a; rotl(d, 8);
+			c += d; b ^= c; rotl(b, 7);
+		}
+
+		template<typename word_type>
+		[[gnu::always_inline]] inline void double_rounds(word_type *x)
+		{
+			for(size_t i=0;i<10;i++) {
+				quarter_round(x[0], x[4], x[8], x[12]);
+				quarter_round(x[1], x[5], x[9], x[13]);
+				quarter_round(x[2], x[6], x[10], x[14]);
+				quarter_round(x[3], x[7], x[11], x[15]);
+				quarter_round(x[0], x[5], x[10], x[15]);
+				quarter_round(x[1], x[6], x[11], x[12]);
+				quarter_round(x[2], x[7], x[8], x[13]);
+				quarter_round(x[3], x[4], x[9], x[14]);
+			}
+		}
+
+		// data[bytes] ^= one block of key stream, bytes up to 64
+		inline void xor_block(std::byte *data, size_t bytes, const std::array<uint32_t, 16> &state)
+		{
+			std::array<uint32_t, 16> x = state;
+			double_rounds(x.data());
+			std::array<std::byte, 64> stream;
+			for(size_t i=0;i<16;i++) {
+				const uint32_t w = x[i]+state[i];
+				std::memcpy(stream.data()+4*i, &w, 4);
+			}
+			for(size_t i=0;i<bytes;i++) data[i] ^= stream[i];
+		}
+
+#if defined(__x86_64__)
+		typedef uint32_t u32x4 __attribute__((vector_size(16)));
+		typedef uint32_t u32x8 __attribute__((vector_size(32)));
+
+		// 4x4 transposes of words within every 128 bits, rows a to d become columns
+		[[gnu::always_inline]] inline void transpose4(u32x4 &a, u32x4 &b, u32x4 &c, u32x4 &d)
+		{
+			typedef int32_t mask_type __attribute__((vector_size(16)));
+			const u32x4 t0 = __builtin_shuffle(a, b, mask_type{0, 4, 1, 5}), t1 = __builtin_shuffle(a, b, mask_type{2, 6, 3, 7});
+			const u32x4 t2 = __builtin_shuffle(c, d, mask_type{0, 4, 1, 5}), t3 = __builtin_shuffle(c, d, mask_type{2, 6, 3, 7});
+			a = __builtin_shuffle(t0, t2, mask_type{0, 1, 4, 5});
+			b = __builtin_shuffle(t0, t2, mask_type{2, 3, 6, 7});
+			c = __builtin_shuffle(t1, t3, mask_type{0, 1, 4, 5});
+			d = __builtin_shuffle(t1, t3, mask_type{2, 3, 6, 7});
+		}
+
+		[[gnu::always_inline]] inline void transpose4(u32x8 &a, u32x8 &b, u32x8 &c, u32x8 &d)
+		{
+			typedef int32_t mask_type __attribute__((vector_size(32)));
+			const mask_type lo32 = {0, 8, 1, 9, 4, 12, 5, 13}, hi32 = {2, 10, 3, 11, 6, 14, 7, 15};
+			const mask_type lo64 = {0, 1, 8, 9, 4, 5, 12, 13}, hi64 = {2, 3, 10, 11, 6, 7, 14, 15};
+			const u32x8 t0 = __builtin_shuffle(a, b, lo32), t1 = __builtin_shuffle(a, b, hi32);
+			const u32x8 t2 = __builtin_shuffle(c, d, lo32), t3 = __builtin_shuffle(c, d, hi32);
+			a = __builtin_shuffle(t0, t2, lo64);
+			b = __builtin_shuffle(t0, t2, hi64);
+			c = __builtin_shuffle(t1, t3, lo64);
+			d = __builtin_shuffle(t1, t3, hi64);
+		}
+
+		// data ^= lanes blocks of key stream, block j of the counter state[12]+j in lane j. Always inlined into the target
+		// specific wrappers like the batch kernels
+		template<typename vec_type, size_t lanes>
+		[[gnu::always_inline]] inline void xor_blocks(std::byte *data, const std::array<uint32_t, 16> &state)
+		{
+			vec_type in[16], x[16];
+			for(size_t i=0;i<16;i++) in[i] = vec_type{}+state[i];
+			for(size_t j=0;j<lanes;j++) in[12][j] += j;
+			for(size_t i=0;i<16;i++) x[i] = in[i];
+			double_rounds(x);
+			for(size_t i=0;i<16;i++) x[i] += in[i];
+
+			// after the transposes x[4g+k] holds words 4g to 4g+3 of block k in its first 128 bits and of block k+4 in
+			// the next 128 bits, 16 bytes of key stream to xor at a time
+			for(size_t g=0;g<4;g++) {
+				transpose4(x[4*g], x[4*g+1], x[4*g+2], x[4*g+3]);
+				for(size_t k=0;k<4;k++) {
+					for(size_t half=0;half<lanes/4;half++) {
+						std::byte *p = data+64*(k+4*half)+16*g;
+						u32x4 stream, text;
+						std::memcpy(&stream, reinterpret_cast<const char *>(&x[4*g+k])+16*half, 16);
+						std::memcpy(&text, p, 16);
+						text ^= stream;
+						std::memcpy(p, &text, 16);
+					}
+				}
+			}
+		}
+
+		__attribute__((target("avx2")))
+		inline void xor_blocks_avx2(std::byte *data, const std::array<uint32_t, 16> &state)
+		{
+			xor_blocks<u32x8, 8>(data, state);
+		}
+
+		inline void xor_blocks_sse2(std::byte *data, const std::array<uint32_t, 16> &state)
+		{
+			xor_blocks<u32x4, 4>(data, state);
+		}
+
+		inline bool detect_avx2()
+		{
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2");
+		}
+
+		inline const bool use_avx2 = detect_avx2(); // checked once at startup
+#endif
+	}; /* NAMESPACE CHACHA */
+
+	inline void chacha20_xor(std::span<std::byte> data, const key_type &key, uint32_t counter, const nonce_type &nonce)
+	{
+		std::array<uint32_t, 16> state = chacha::initial_state(key, counter, nonce);
+		std::byte *p = data.data();
+		size_t bytes = data.size();
+#if defined(__x86_64__)
+		if(chacha::use_avx2) {
+			for(;bytes>=512;bytes-=512,p+=512,state[12]+=8)
+				chacha::xor_blocks_avx2(p, state);
+		}
+		for(;bytes>=256;bytes-=256,p+=256,state[12]+=4)
+			chacha::xor_blocks_sse2(p, state);
+#endif
+		for(;bytes>0;state[12]++) {
+			const size_t n = std::min<size_t>(bytes, 64);
+			chacha::xor_block(p, n, state);
+			p += n;
+			bytes -= n;
+		}
+	}
+
+	inline Poly1305::Poly1305(std::span<const std::byte, 32> key)
+	{
+		// r is clamped as the RFC asks, s is added at the end
+		const uint64_t t0 = chacha::load64(key.data()), t1 = chacha::load64(key.data()+8);
+		r[0] = t0 & 0xffc0fffffff;
+		r[1] = ((t0 >> 44) | (t1 << 20)) & 0xfffffc0ffff;
+		r[2] = (t1 >> 24) & 0x00ffffffc0f;
+		h[0] = h[1] = h[2] = 0;
+		pad[0] = chacha::load64(key.data()+16);
+		pad[1] = chacha::load64(key.data()+24);
+	}
+
+	inline void Poly1305::blocks(const std::byte *m, size_t bytes, uint64_t hibit)
+	{
+		constexpr const uint64_t mask44 = 0xfffffffffff, mask42 = 0x3ffffffffff;
+		const uint64_t r0 = r[0], r1 = r[1], r2 = r[2];
+		const uint64_t s1 = r1*(5 << 2), s2 = r2*(5 << 2); // 2^130 = 5 mod p, shifted for the limb sizes
+		uint64_t h0 = h[0], h1 = h[1], h2 = h[2];
+		for(;bytes>=16;bytes-=16,m+=16) {
+			const uint64_t t0 = chacha::load64(m), t1 = chacha::load64(m+8);
+			h0 += t0 & mask44;
+			h1 += ((t0 >> 44) | (t1 << 20)) & mask44;
+			h2 += ((t1 >> 24) & mask42) | hibit;
+
+			// h *= r mod 2^130-5 with partial reduction, the limbs stay just above their sizes
+			unsigned __int128 d0 = (unsigned __int128)h0*r0 + (unsigned __int128)h1*s2 + (unsigned __int128)h2*s1;
+			unsigned __int128 d1 = (unsigned __int128)h0*r1 + (unsigned __int128)h1*r0 + (unsigned __int128)h2*s2;
+			unsigned __int128 d2 = (unsigned __int128)h0*r2 + (unsigned __int128)h1*r1 + (unsigned __int128)h2*r0;
+			uint64_t c = uint64_t(d0 >> 44); h0 = uint64_t(d0) & mask44;
+			d1 += c; c = uint64_t(d1 >> 44); h1 = uint64_t(d1) & mask44;
+			d2 += c; c = uint64_t(d2 >> 42); h2 = uint64_t(d2) & mask42;
+			h0 += c*5; c = h0 >> 44; h0 &= mask44;
+			h1 += c;
+		}
+		h[0] = h0; h[1] = h1; h[2] = h2;
+	}
+
+	inline void Poly1305::update(std::span<const std::byte> data)
+	{
+		constexpr const uint64_t hibit = uint64_t(1) << 40; // the 2^128 of every full block
+		size_t i = 0;
+		if(buffered) {
+			const size_t n = std::min(16-buffered, data.size());
+			std::copy_n(data.begin(), n, buffer.begin()+buffered);
+			buffered += n;
+			i = n;
+			if(buffered < 16) return;
+			blocks(buffer.data(), 16, hibit);
+			buffered = 0;
+		}
+		const size_t full = (data.size()-i) & ~size_t(15);
+		blocks(data.data()+i, full, hibit);
+		i += full;
+		std::copy(data.begin()+i, data.end(), buffer.begin());
+		buffered = data.size()-i;
+	}
+
+	inline tag_type Poly1305::finish()
+	{
+		constexpr const uint64_t mask44 = 0xfffffffffff, mask42 = 0x3ffffffffff;
+		if(buffered) {
+			// the partial block gets its 1 right after the data instead of at 2^128
+			buffer[buffered] = std::byte(1);
+			std::fill(buffer.begin()+buffered+1, buffer.end(), std::byte(0));
+			blocks(buffer.data(), 16, 0);
+		}
+
+		// full carry, then h-p if h >= p picked without a branch
+		uint64_t h0 = h[0], h1 = h[1], h2 = h[2], c;
+		c = h1 >> 44; h1 &= mask44; h2 += c;
+		c = h2 >> 42; h2 &= mask42; h0 += c*5;
+		c = h0 >> 44; h0 &= mask44; h1 += c;
+		c = h1 >> 44; h1 &= mask44; h2 += c;
+		c = h2 >> 42; h2 &= mask42; h0 += c*5;
+		c = h0 >> 44; h0 &= mask44; h1 += c;
+
+		uint64_t g0 = h0+5; c = g0 >> 44; g0 &= mask44;
+		uint64_t g1 = h1+c; c = g1 >> 44; g1 &= mask44;
+		uint64_t g2 = h2+c-(uint64_t(1) << 42);
+		const uint64_t use_g = (g2 >> 63)-1; // all ones if h-p didn't go negative
+		h0 = (h0 & ~use_g) | (g0 & use_g);
+		h1 = (h1 & ~use_g) | (g1 & use_g);
+		h2 = (h2 & ~use_g) | (g2 & use_g);
+
+		// tag = h+s mod 2^128
+		h0 += pad[0] & mask44; c = h0 >> 44; h0 &= mask44;
+		h1 += (((pad[0] >> 44) | (pad[1] << 20)) & mask44)+c; c = h1 >> 44; h1 &= mask44;
+		h2 += ((pad[1] >> 24) & mask42)+c; h2 &= mask42;
+
+		tag_type tag;
+		chacha::store64(tag.data(), h0 | (h1 << 44));
+		chacha::store64(tag.data()+8, (h1 >> 20) | (h2 << 24));
+		return tag;
+	}
+
+	namespace chacha
+	{
+		// Poly1305 over aad, the ciphertext and their lengths, each padded to 16 bytes, keyed with block 0
+		inline tag_type aead_tag(std::span<const std::byte> ciphertext, const key_type &key, const nonce_type &nonce,
+		                         std::span<const std::byte> aad)
+		{
+			std::array<std::byte, 64> otk{};
+			chacha20_xor(otk, key, 0, nonce);
+			Poly1305 mac(std::span<const std::byte, 32>(otk.data(), 32));
+			const std::array<std::byte, 16> zeros{};
+			mac.update(aad);
+			mac.update(std::span<const std::byte>(zeros).first((16-aad.size()%16)%16));
+			mac.update(ciphertext);
+			mac.update(std::span<const std::byte>(zeros).first((16-ciphertext.size()%16)%16));
+			std::array<std::byte, 16> lengths;
+			store64(lengths.data(), aad.size());
+			store64(lengths.data()+8, ciphertext.size());
+			mac.update(lengths);
+			return mac.finish();
+		}
+	}; /* NAMESPACE CHACHA */
+
+	inline tag_type seal(std::span<std::byte> data, const key_type &key, const nonce_type &nonce, std::span<const std::byte> aad)
+	{
+		chacha20_xor(data, key, 1, nonce);
+		return chacha::aead_tag(data, key, nonce, aad);
+	}
+
+	inline void open(std::span<std::byte> data, const tag_type &tag, const key_type &key, const nonce_type &nonce,
+	                 std::span<const std::byte> aad)
+	{
+		const tag_type expected = chacha::aead_tag(data, key, nonce, aad);
+		uint8_t diff = 0;
+		for(size_t i=0;i<tag_size;i++)
+			diff |= uint8_t(expected[i] ^ tag[i]);
+		if(diff != 0) throw authentication_error("ChaCha20-Poly1305 tag mismatch");
+		chacha20_xor(data, key, 1, nonce);
+	}
+
+	inline nonce_type stream_nonce(uint64_t index, bool last)
+	{
+		nonce_type nonce{};
+		for(size_t i=0;i<8;i++)
+			nonce[3+i] = std::byte(index >> (56-8*i));
+		nonce[11] = std::byte(last);
+		return nonce;
+	}
+
+	inline StreamEncryptor::StreamEncryptor(const key_type &key, size_t chunk_size, std::span<const std::byte> aad)
+		: key(key), chunk_size(chunk_size), aad(aad.begin(), aad.end())
+	{
+		if(chunk_size == 0 || chunk_size > max_chunk_size)
+			throw stream_error("chunk size has to be between 1 byte and max_chunk_size");
+		pending.reserve(chunk_size);
+	}
+
+	inline void StreamEncryptor::seal_chunk(std::span<const std::byte> chunk, bool last, std::vector<std::byte> &out)
+	{
+		const size_t offset = out.size();
+		out.insert(out.end(), chunk.begin(), chunk.end());
+		const tag_type tag = seal(std::span<std::byte>(out.data()+offset, chunk.size()), key, stream_nonce(index++, last), aad);
+		out.insert(out.end(), tag.begin(), tag.end());
+	}
+
+	inline void StreamEncryptor::update(std::span<const std::byte> data, std::vector<std::byte> &out)
+	{
+		// a full pending chunk is sealed only once more data shows it isn't the last one
+		size_t i = 0;
+		while(i < data.size()) {
+			if(pending.size() == chunk_size) {
+				seal_chunk(pending, false, out);
+				pending.clear();
+			}
+			if(pending.empty() && data.size()-i > chunk_size) {
+				seal_chunk(data.subspan(i, chunk_size), false, out);
+				i += chunk_size;
+				continue;
+			}
+			const size_t n = std::min(chunk_size-pending.size(), data.size()-i);
+			pending.insert(pending.end(), data.begin()+i, data.begin()+i+n);
+			i += n;
+		}
+	}
+
+	inline void StreamEncryptor::finish(std::vector<std::byte> &out)
+	{
+		seal_chunk(pending, true, out);
+		pending.clear();
+	}
+
+	inline StreamDecryptor::StreamDecryptor(const key_type &key, size_t chunk_size, std::span<const std::byte> aad)
+		: key(key), chunk_size(chunk_size), aad(aad.begin(), aad.end())
+	{
+		// nothing is reserved up front, the buffer only grows with data that actually arrives
+		if(chunk_size == 0 || chunk_size > max_chunk_size)
+			throw stream_error("chunk size has to be between 1 byte and max_chunk_size");
+	}
+
+	inline void StreamDecryptor::open_chunk(std::span<const std::byte> chunk, bool last, std::vector<std::byte> &out)
+	{
+		if(chunk.size() < tag_size) throw authentication_error("stream chunk shorter than its tag");
+		const size_t size = chunk.size()-tag_size, offset = out.size();
+		tag_type tag;
+		std::copy(chunk.begin()+size, chunk.end(), tag.begin());
+		out.insert(out.end(), chunk.begin(), chunk.begin()+size);
+		try {
+			open(std::span<std::byte>(out.data()+offset, size), tag, key, stream_nonce(index++, last), aad);
+		} catch(const authentication_error &) {
+			out.resize(offset);
+			throw;
+		}
+	}
+
+	inline void StreamDecryptor::update(std::span<const std::byte> data, std::vector<std::byte> &out)
+	{
+		const size_t sealed_size = chunk_size+tag_size;
+		size_t i = 0;
+		while(i < data.size()) {
+			if(pending.size() == sealed_size) {
+				open_chunk(pending, false, out);
+				pending.clear();
+			}
+			if(pending.empty() && data.size()-i > sealed_size) {
+				open_chunk(data.subspan(i, sealed_size), false, out);
+				i += sealed_size;
+				continue;
+			}
+			const size_t n = std::min(sealed_size-pending.size(), data.size()-i);
+			pending.insert(pending.end(), data.begin()+i, data.begin()+i+n);
+			i += n;
+		}
+	}
+
+	inline void StreamDecryptor::finish(std::vector<std::byte> &out)
+	{
+		open_chunk(pending, true, out);
+		pending.clear();
+	}
+}; /* NAMESPACE AEAD */
+
+#endif /* CHACHA20POLY1305_CPP */
@@ -0,0 +1,122 @@
+#ifndef CHACHA20POLY1305_H
+#define CHACHA20POLY1305_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <span>
+#include <vector>
+#include <stdexcept>
+
+// ChaCha20-Poly1305 authenticated encryption (RFC 8439) and a chunked stream format on top of it for payloads of any
+// size. ChaCha20 runs 8 blocks at once in AVX2 lanes or 4 in SSE2 lanes, Poly1305 works on 44-bit limbs with 128-bit
+// products. Every chunk is sealed on its own, its nonce is the chunk index and a flag for the last chunk, so chunks
+// can't be reordered, dropped or cut off at the end without the tag check failing
+
+namespace Aead
+{
+	// raise when a tag doesn't match, nothing of the chunk is released
+	class authentication_error : public std::runtime_error {
+		public: explicit authentication_error(const char *str) : std::runtime_error(str) {}
+	};
+
+	// raise when a stream can't be encrypted or decrypted with the given parameters
+	class stream_error : public std::runtime_error {
+		public: explicit stream_error(const char *str) : std::runtime_error(str) {}
+	};
+
+	constexpr const size_t key_size = 32;
+	constexpr const size_t nonce_size = 12;
+	constexpr const size_t tag_size = 16;
+	// largest chunk of a stream. A decryptor holds a whole chunk before it can check its tag, and the chunk size of a
+	// stream read from a ciphertext is untrusted until then, so it is capped at a few MiB
+	constexpr const size_t max_chunk_size = 16*1024*1024;
+	typedef std::array<std::byte, key_size> key_type;
+	typedef std::array<std::byte, nonce_size> nonce_type;
+	typedef std::array<std::byte, tag_size> tag_type;
+
+	// data ^= ChaCha20 key stream starting at block counter, in place
+	inline void chacha20_xor(std::span<std::byte> data, const key_type &key, uint32_t counter, const nonce_type &nonce);
+
+	// one-time authenticator, the key must never be used for a second message
+	class Poly1305
+	{
+		public:
+			explicit Poly1305(std::span<const std::byte, 32> key);
+
+			void update(std::span<const std::byte> data);
+
+			tag_type finish();
+
+		protected:
+			uint64_t r[3], h[3], pad[2]; // 44, 44 and 42 bit limbs
+			std::array<std::byte, 16> buffer;
+			size_t buffered = 0;
+
+			void blocks(const std::byte *m, size_t bytes, uint64_t hibit);
+	};
+
+	// encrypts data in place and returns the tag over aad and the ciphertext
+	inline tag_type seal(std::span<std::byte> data, const key_type &key, const nonce_type &nonce, std::span<const std::byte> aad = {});
+
+	// checks the tag in constant time and decrypts data in place, throws authentication_error and leaves data encrypted
+	// if the tag doesn't match
+	inline void open(std::span<std::byte> data, const tag_type &tag, const key_type &key, const nonce_type &nonce,
+	                 std::span<const std::byte> aad = {});
+
+	// nonce of chunk index of a stream, the index in the first 11 bytes big endian and 1 in the last byte for the last chunk
+	inline nonce_type stream_nonce(uint64_t index, bool last);
+
+	// Seals a stream in chunks of chunk_size bytes, each followed by its tag, with aad authenticated in every chunk.
+	// The chunk that arrives last is only sealed by finish, so the end of the stream is marked even when its length
+	// is a multiple of chunk_size. An empty stream is one empty chunk. chunk_size is 1 to max_chunk_size bytes
+	class StreamEncryptor
+	{
+		public:
+			StreamEncryptor(const key_type &key, size_t chunk_size, std::span<const std::byte> aad = {});
+
+			// appends the sealed chunks that are complete and not the last one to out
+			void update(std::span<const std::byte> data, std::vector<std::byte> &out);
+
+			// appends the last chunk, the encryptor can't be used afterwards
+			void finish(std::vector<std::byte> &out);
+
+		protected:
+			key_type key;
+			size_t chunk_size;
+			std::vector<std::byte> aad;
+			std::vector<std::byte> pending; // up to chunk_size plaintext bytes
+			uint64_t index = 0;
+
+			void seal_chunk(std::span<const std::byte> chunk, bool last, std::vector<std::byte> &out);
+	};
+
+	// Opens a stream of StreamEncryptor. Chunks are released only after their tag checked out, a full chunk is held
+	// back until more data shows it isn't the last one. Throws authentication_error for a tampered, reordered or
+	// truncated stream
+	class StreamDecryptor
+	{
+		public:
+			StreamDecryptor(const key_type &key, size_t chunk_size, std::span<const std::byte> aad = {});
+
+			// appends the plaintext of the chunks that are complete and not the last one to out
+			void update(std::span<const std::byte> data, std::vector<std::byte> &out);
+
+			// opens the last chunk, throws authentication_error if the stream ended anywhere else
+			void finish(std::vector<std::byte> &out);
+
+		protected:
+			key_type key;
+			size_t chunk_size;
+			std::vector<std::byte> aad;
+			std::vector<std::byte> pending; // up to chunk_size+tag_size sealed bytes
+			uint64_t index = 0;
+
+			void open_chunk(std::span<const std::byte> chunk, bool last, std::vector<std::byte> &out);
+	};
+}; /* NAMESPACE AEAD */
+
+// include here because of the single translation unit build
+#include "chacha20poly1305.cpp"
+
+#endif /* CHACHA20POLY1305_H */
@@ -0,0 +1,314 @@
+#ifndef DECIMAL_CPP
+#define DECIMAL_CPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+#include "decimal.h"
+
+namespace BigInt
+{
+	namespace decimal
+	{
+		inline constexpr uint64_t reciprocal_word(uint64_t d)
+		{
+			// floor((2^128-1)/d) - 2^64 = floor((~d*2^64 + 2^64-1)/d)
+			return (uint64_t)(((__uint128_t)~d << 64 | ~uint64_t(0))/d);
+		}
+
+		inline constexpr uint64_t div_2by1_preinv(uint64_t hi, uint64_t lo, uint64_t d, uint64_t dinv, uint64_t &rem)
+		{
+			__uint128_t q = (__uint128_t)dinv*hi;
+			q += ((__uint128_t)(hi+1) << 64) | lo; // hi < d, so hi+1 can't overflow
+			uint64_t q1 = q >> 64;
+			const uint64_t q0 = (uint64_t)q;
+			uint64_t r = lo - q1*d;
+			if(r > q0) { // estimate one too large
+				q1--;
+				r += d;
+			}
+			if(r >= d) { // rarely one too small
+				q1++;
+				r -= d;
+			}
+			rem = r;
+			return q1;
+		}
+
+		inline constexpr uint64_t divrem_1_preinv(uint64_t *q, const uint64_t *a, size_t n, uint64_t d, uint64_t dinv)
+		{
+			uint64_t rem = 0;
+			for(size_t i=0;i<n;i++) q[i] = div_2by1_preinv(rem, a[i], d, dinv, rem);
+			return rem;
+		}
+
+		inline constexpr size_t max_digits(size_t bits)
+		{
+			return bits*30103/100000+1; // log10(2) < 0.30103
+		}
+
+		inline constexpr size_t limbs_for_digits(size_t len)
+		{
+			return (len*217706 >> 22)+2; // log2(10)/64 < 217706/2^22
+		}
+
+		inline powers::powers(size_t n)
+		{
+			std::vector<uint64_t> current = {chunk}, square, quotient, scratch;
+			for(;;) {
+				const size_t m = current.size();
+				offsets.push_back(storage.size());
+				storage.insert(storage.end(), current.begin(), current.end());
+
+				// Barrett inverse floor(2^(128m)/power), at most 2^(64(m+1)) so it fits m+2 limbs
+				std::vector<uint64_t> num(2*m+1, 0);
+				num[0] = 1;
+				quotient.assign(2*m+1, 0);
+				scratch.resize(3*m+2);
+				limb::divrem(quotient.data(), nullptr, num.data(), 2*m+1, current.data(), m, scratch.data());
+				offsets.push_back(storage.size());
+				storage.insert(storage.end(), quotient.end()-(m+2), quotient.end());
+				sizes.push_back(m);
+
+				// power^2 > 2^(64(2m-2)), past that the largest n-limb number fits below the square of this level
+				if(2*m >= n+2) break;
+				square.assign(2*m, 0);
+				scratch.resize(limb::sqr_n_scratch_size(m));
+				limb::sqr_n(square.data(), current.data(), m, scratch.data());
+				const size_t skip = square[0] == 0 ? 1 : 0;
+				current.assign(square.begin()+skip, square.end());
+			}
+		}
+
+		template<size_t n>
+		inline const powers &powers_for()
+		{
+			static const powers table(n);
+			return table;
+		}
+
+		inline constexpr size_t scratch_size(size_t n)
+		{
+			return 8*n+128+4*limb::mul_n_scratch_size_upto(n+4);
+		}
+
+		// skip leading zero limbs, returns the new length
+		inline size_t normalize(const uint64_t *&a, size_t n)
+		{
+			while(n > 0 && a[0] == 0) {
+				a++;
+				n--;
+			}
+			return n;
+		}
+
+		// a[n] >= b[m] for a normalized b
+		inline bool greater_equal(const uint64_t *a, size_t n, const uint64_t *b, size_t m)
+		{
+			for(size_t i=0;i+m<n;i++) {
+				if(a[i] != 0) return true;
+			}
+			return limb::cmp(a+n-m, b, m) >= 0;
+		}
+
+		// q[n-m+2] = a[n]/p[m] and r[n] = a[n]%p[m] for a < 2^(128m) with the Barrett inverse mu[m+2]
+		inline void divrem_preinv(uint64_t *q, uint64_t *r, const uint64_t *a, size_t n, const uint64_t *p, size_t m,
+		                          const uint64_t *mu, uint64_t *scratch)
+		{
+			const size_t qn = n-m+2, l1 = n-m+1;
+			uint64_t *q2 = scratch, *t = q2+l1+m+2, *next = t+qn+m;
+
+			// q = floor(floor(a/2^(64(m-1)))*mu / 2^(64(m+1))) is at most 2 too small
+			limb::mul(q2, a, l1, mu, m+2, next);
+			std::copy(q2, q2+qn, q);
+			limb::mul(t, q, qn, p, m, next);
+			limb::sub_n(r, a, t+qn+m-n, n); // q*p <= a, so the limbs above n are zero
+			while(greater_equal(r, n, p, m)) {
+				limb::sub(r, r, n, p, m);
+				limb::add_1(q, q, qn, 1);
+			}
+		}
+
+		// 10^i for i < 20
+		constexpr const std::array<uint64_t, 20> powers_of_ten = []() {
+			std::array<uint64_t, 20> pow{};
+			pow[0] = 1;
+			for(size_t i=1;i<20;i++) pow[i] = pow[i-1]*10;
+			return pow;
+		}();
+
+		// "00" to "99", two digits per division
+		constexpr const std::array<char, 200> digit_pairs = []() {
+			std::array<char, 200> pairs{};
+			for(size_t i=0;i<100;i++) {
+				pairs[2*i] = '0'+i/10;
+				pairs[2*i+1] = '0'+i%10;
+			}
+			return pairs;
+		}();
+
+		// digits of one chunk below 10^19, right aligned in str[count]
+		inline void put_chunk(char *str, uint64_t v, size_t count)
+		{
+			size_t i = count;
+			for(;i >= 2;i-=2, v/=100) std::memcpy(str+i-2, digit_pairs.data()+2*(v%100), 2);
+			if(i == 1) str[0] = '0'+v%10;
+		}
+
+		// value of 8 digits, most significant first. Pairs, then quads and then both halves are combined with one multiply each
+		inline uint64_t parse_8(const char *str)
+		{
+			if constexpr(std::endian::native == std::endian::little) {
+				uint64_t v;
+				std::memcpy(&v, str, 8);
+				v -= 0x3030303030303030ULL;
+				v = v*10+(v >> 8);
+				v = ((v & 0x000000ff000000ffULL)*(100+(1000000ULL << 32))+((v >> 16) & 0x000000ff000000ffULL)*(1+(10000ULL << 32))) >> 32;
+				return v;
+			} else {
+				uint64_t v = 0;
+				for(size_t i=0;i<8;i++) v = v*10+(str[i]-'0');
+				return v;
+			}
+		}
+
+		// value of count <= 19 digits
+		inline uint64_t parse_chunk(const char *str, size_t count)
+		{
+			uint64_t v = 0;
+			for(;count%8 != 0;count--) v = v*10+(*str++-'0');
+			for(;count != 0;count-=8, str+=8) v = v*100000000+parse_8(str);
+			return v;
+		}
+
+		// digits of a chunk without leading zeros, at least 1
+		inline size_t chunk_length(uint64_t v)
+		{
+			size_t len = 1;
+			for(;v >= 10;v/=10) len++;
+			return len;
+		}
+
+		// 19 digits at a time from the bottom, every chunk is one pass of divrem_1_preinv over the limbs
+		inline size_t get_str_basecase(char *str, const uint64_t *a, size_t n, size_t width, uint64_t *scratch)
+		{
+			constexpr const uint64_t chunk_inverse = reciprocal_word(chunk);
+			uint64_t *t = scratch, *chunks = t+n;
+			std::copy(a, a+n, t);
+			size_t count = 0;
+			for(size_t start=0;start<n;) {
+				chunks[count++] = divrem_1_preinv(t+start, t+start, n-start, chunk, chunk_inverse);
+				if(t[start] == 0) start++;
+			}
+
+			const size_t top = count == 0 ? 1 : chunk_length(chunks[count-1]);
+			const size_t len = count == 0 ? 1 : (count-1)*chunk_digits+top;
+			const size_t total = std::max(width, len);
+			std::fill(str, str+total-len, '0');
+			char *pos = str+total;
+			for(size_t i=0;i+1<count;i++) {
+				pos -= chunk_digits;
+				put_chunk(pos, chunks[i], chunk_digits);
+			}
+			put_chunk(pos-top, count == 0 ? 0 : chunks[count-1], top);
+			return total;
+		}
+
+		// digits of a[n], exactly width digits if width isn't 0
+		inline size_t get_str_rec(char *str, const uint64_t *a, size_t n, size_t width, const powers &p, uint64_t *scratch)
+		{
+			n = normalize(a, n);
+			if(n < dc_threshold) return get_str_basecase(str, a, n, width, scratch);
+
+			// smallest power whose square is above a, so the quotient and remainder have about half the limbs
+			size_t k = 0;
+			while(2*p.size(k) < n) k++;
+			const size_t m = p.size(k); // m < n since the previous level had less than n/2 limbs
+
+			uint64_t *q = scratch, *r = q+n-m+2, *next = r+n;
+			divrem_preinv(q, r, a, n, p.power(k), m, p.inverse(k), next);
+
+			// the quotient gets the leading digits, the remainder is padded to exactly digits(k)
+			size_t len = 0;
+			const uint64_t *q_norm = q;
+			if(const size_t qs = normalize(q_norm, n-m+2); qs != 0) {
+				len = get_str_rec(str, q_norm, qs, width == 0 ? 0 : width-p.digits(k), p, next);
+			} else if(width != 0) {
+				len = width-p.digits(k);
+				std::fill(str, str+len, '0');
+			}
+			return len+get_str_rec(str+len, r, n, p.digits(k), p, next);
+		}
+
+		inline size_t get_str(char *str, const uint64_t *a, size_t n, const powers &p, uint64_t *scratch)
+		{
+			return get_str_rec(str, a, n, 0, p, scratch);
+		}
+
+		// value of str[len] in x[xn], xn >= limbs_for_digits(len)
+		inline void set_str_rec(uint64_t *x, size_t xn, const char *str, size_t len, const powers &p, uint64_t *scratch)
+		{
+			std::fill(x, x+xn, 0);
+			if(len <= dc_threshold*chunk_digits) {
+				size_t used = 1; // limbs that can be non-zero
+				for(size_t i=0;i<len;) {
+					const size_t count = i == 0 && len%chunk_digits != 0 ? len%chunk_digits : chunk_digits;
+					const uint64_t v = parse_chunk(str+i, count);
+					i += count;
+					uint64_t *low = x+xn-used;
+					const uint64_t scale = count == chunk_digits ? chunk : powers_of_ten[count];
+					const uint64_t carry = limb::mul_1(low, low, used, scale) + limb::add_1(low, low, used, v);
+					if(carry != 0) x[xn-1-used++] = carry;
+				}
+				return;
+			}
+
+			// largest power with fewer digits than str: str = hi*10^(19*2^k) + lo
+			size_t k = 0;
+			while(k+1 < p.levels() && p.digits(k+1) < len) k++;
+			const size_t lo_len = p.digits(k), hi_len = len-lo_len, m = p.size(k);
+			const size_t hn = limbs_for_digits(hi_len), ln = limbs_for_digits(lo_len);
+			uint64_t *hi = scratch, *lo = hi+hn, *t = lo+ln, *next = t+hn+m;
+			set_str_rec(hi, hn, str, hi_len, p, next);
+			set_str_rec(lo, ln, str+hi_len, lo_len, p, next);
+
+			const uint64_t *hi_norm = hi, *lo_norm = lo;
+			const size_t hs = normalize(hi_norm, hn), ls = normalize(lo_norm, ln); // lo < 10^(19*2^k) so ls <= m
+			if(hs == 0) {
+				std::copy(lo_norm, lo_norm+ls, x+xn-ls);
+				return;
+			}
+			limb::mul(t, hi_norm, hs, p.power(k), m, next);
+			limb::add(t, t, hs+m, lo_norm, ls);
+			const size_t tn = std::min(hs+m, xn); // the value fits xn limbs, anything above is zero
+			std::copy(t+hs+m-tn, t+hs+m, x+xn-tn);
+		}
+
+		inline bool set_str(uint64_t *r, size_t n, const char *str, size_t len, const powers &p, uint64_t *scratch)
+		{
+			while(len > 0 && str[0] == '0') {
+				str++;
+				len--;
+			}
+			if(len > max_digits(64*n)) return false;
+
+			const size_t xn = limbs_for_digits(len);
+			uint64_t *x = scratch;
+			set_str_rec(x, xn, str, len, p, x+xn);
+			for(size_t i=0;i+n<xn;i++) {
+				if(x[i] != 0) return false;
+			}
+			std::fill(r, r+n, 0);
+			const size_t count = std::min(n, xn);
+			std::copy(x+xn-count, x+xn, r+n-count);
+			return true;
+		}
+	}; /* NAMESPACE DECIMAL */
+}; /* NAMESPACE BIGINT */
+
+#endif /* DECIMAL_CPP */
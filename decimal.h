@@ -0,0 +1,80 @@
+#ifndef DECIMAL_H
+#define DECIMAL_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "limb.h"
+
+// limb count where decimal conversion switches from chunks of 19 digits to divide and conquer, can be tuned with -D
+#ifndef BIGINT_DECIMAL_DC_THRESHOLD
+#define BIGINT_DECIMAL_DC_THRESHOLD 20
+#endif
+
+// Decimal conversion of limb arrays (same big-endian limb order as limb.h). Small numbers are converted 19 digits at a time
+// with one pass over the limbs per chunk. Larger numbers are split by the powers 10^(19*2^k): printing divides by them with a
+// precomputed Barrett inverse and parsing multiplies by them, so both directions run in O(M(n) log n) with Karatsuba/Toom-3
+
+namespace BigInt
+{
+	namespace decimal
+	{
+		constexpr const size_t dc_threshold = BIGINT_DECIMAL_DC_THRESHOLD;
+		static_assert(dc_threshold >= 2, "decimal threshold is too small for the divide and conquer split");
+		constexpr const uint64_t chunk = 10000000000000000000ULL; // 10^19, the largest power of 10 in a limb
+		constexpr const size_t chunk_digits = 19;
+
+		// floor((2^128-1)/d) - 2^64 for a d with the top bit set, the reciprocal used by div_2by1_preinv
+		inline constexpr uint64_t reciprocal_word(uint64_t d);
+
+		// (hi*2^64 + lo) / d with a precomputed reciprocal (Moller-Granlund), two multiplications instead of a hardware divide.
+		// d has to have the top bit set and hi < d. rem gets the remainder
+		inline constexpr uint64_t div_2by1_preinv(uint64_t hi, uint64_t lo, uint64_t d, uint64_t dinv, uint64_t &rem);
+
+		// q[n] = a[n]/d, returns a[n]%d. d has to have the top bit set. q can be a
+		inline constexpr uint64_t divrem_1_preinv(uint64_t *q, const uint64_t *a, size_t n, uint64_t d, uint64_t dinv);
+
+		// decimal digits of a number with bits significant bits, rounded up
+		inline constexpr size_t max_digits(size_t bits);
+
+		// limbs that hold any number of len decimal digits
+		inline constexpr size_t limbs_for_digits(size_t len);
+
+		// 10^(19*2^k) for k = 0, 1, ... and their Barrett inverses floor(2^(128m)/10^(19*2^k)) where m is the limb count of the power.
+		// Built once for an operand size, read only afterwards so it can be shared between threads
+		class powers
+		{
+			protected:
+				std::vector<uint64_t> storage;
+				std::vector<size_t> offsets; // power k starts at offsets[2k], its inverse at offsets[2k+1]
+				std::vector<size_t> sizes; // limbs of power k, the inverse has sizes[k]+2 limbs
+
+			public:
+				// every power needed to convert numbers of up to n limbs
+				explicit powers(size_t n);
+
+				inline size_t levels() const { return sizes.size(); }
+				inline const uint64_t *power(size_t k) const { return storage.data()+offsets[2*k]; }
+				inline const uint64_t *inverse(size_t k) const { return storage.data()+offsets[2*k+1]; }
+				inline size_t size(size_t k) const { return sizes[k]; }
+				inline size_t digits(size_t k) const { return chunk_digits << k; }
+		};
+
+		// scratch limbs for get_str and set_str on numbers of up to n limbs
+		inline constexpr size_t scratch_size(size_t n);
+
+		// writes the decimal digits of a[n] without leading zeros ("0" for zero) to str, returns the count.
+		// str needs room for max_digits(64*n) characters. p has to be built for at least n limbs
+		inline size_t get_str(char *str, const uint64_t *a, size_t n, const powers &p, uint64_t *scratch);
+
+		// r[n] from len decimal digits in str, most significant first. The digits aren't validated.
+		// Returns false if the value doesn't fit n limbs
+		inline bool set_str(uint64_t *r, size_t n, const char *str, size_t len, const powers &p, uint64_t *scratch);
+	}; /* NAMESPACE DECIMAL */
+}; /* NAMESPACE BIGINT */
+
+// include here because of inline definitions
+#include "decimal.cpp"
+
+#endif /* DECIMAL_H */
@@ -0,0 +1,963 @@
+#ifndef LIMB_CPP
+#define LIMB_CPP
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <utility>
+#include <bit>
+#include <array>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#include <cpuid.h>
+#endif
+
+#include "limb.h"
+
+namespace BigInt
+{
+	namespace limb
+	{
+		inline kernel_set detect_kernel_set()
+		{
+#if defined(__x86_64__)
+			unsigned eax, ebx, ecx, edx;
+			if(__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+				const bool bmi2 = ebx & (1u << 8), adx = ebx & (1u << 19);
+				if(bmi2 && adx) return kernel_set::mulx_adx;
+			}
+#endif
+			return kernel_set::portable;
+		}
+
+		inline kernel_set active_kernels = detect_kernel_set(); // initialized once at startup
+
+		inline kernel_set active_kernel_set()
+		{
+			return active_kernels;
+		}
+
+		inline bool select_kernel_set(kernel_set ks)
+		{
+			if(ks == kernel_set::mulx_adx && detect_kernel_set() != kernel_set::mulx_adx) return false;
+			active_kernels = ks;
+			return true;
+		}
+
+		inline constexpr const char *kernel_set_name(kernel_set ks)
+		{
+			switch(ks) {
+				case kernel_set::mulx_adx: return "mulx_adx";
+				default: return "portable";
+			}
+		}
+
+		inline constexpr int cmp(const uint64_t *a, const uint64_t *b, size_t n)
+		{
+			for(size_t i=0;i<n;i++) {
+				if(a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+			}
+			return 0;
+		}
+
+		inline constexpr uint64_t add_n(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n)
+		{
+#if defined(__x86_64__)
+			if !consteval {
+				// single adc chain, the carry stays in the flags register between limbs
+				unsigned char carry = 0;
+				unsigned long long t;
+				size_t i = n;
+				for(;i >= 4;i -= 4) {
+					carry = _addcarry_u64(carry, a[i-1], b[i-1], &t); r[i-1] = t;
+					carry = _addcarry_u64(carry, a[i-2], b[i-2], &t); r[i-2] = t;
+					carry = _addcarry_u64(carry, a[i-3], b[i-3], &t); r[i-3] = t;
+					carry = _addcarry_u64(carry, a[i-4], b[i-4], &t); r[i-4] = t;
+				}
+				while(i --> 0) {
+					carry = _addcarry_u64(carry, a[i], b[i], &t); r[i] = t;
+				}
+				return carry;
+			}
+#endif
+			uint64_t carry = 0;
+			for(size_t i=n;i --> 0;) {
+				__uint128_t t = (__uint128_t)a[i] + b[i] + carry;
+				r[i] = (uint64_t)t;
+				carry = t >> 64;
+			}
+			return carry;
+		}
+
+		inline constexpr uint64_t sub_n(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n)
+		{
+#if defined(__x86_64__)
+			if !consteval {
+				unsigned char borrow = 0;
+				unsigned long long t;
+				size_t i = n;
+				for(;i >= 4;i -= 4) {
+					borrow = _subborrow_u64(borrow, a[i-1], b[i-1], &t); r[i-1] = t;
+					borrow = _subborrow_u64(borrow, a[i-2], b[i-2], &t); r[i-2] = t;
+					borrow = _subborrow_u64(borrow, a[i-3], b[i-3], &t); r[i-3] = t;
+					borrow = _subborrow_u64(borrow, a[i-4], b[i-4], &t); r[i-4] = t;
+				}
+				while(i --> 0) {
+					borrow = _subborrow_u64(borrow, a[i], b[i], &t); r[i] = t;
+				}
+				return borrow;
+			}
+#endif
+			uint64_t borrow = 0;
+			for(size_t i=n;i --> 0;) {
+				const uint64_t ai = a[i], bi = b[i];
+				r[i] = ai - bi - borrow;
+				borrow = (ai < bi) | ((ai == bi) & borrow);
+			}
+			return borrow;
+		}
+
+		inline constexpr uint64_t add_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b)
+		{
+			for(size_t i=n;i --> 0;) {
+				r[i] = a[i] + b;
+				b = r[i] < b;
+				if(b == 0) { // nothing left to carry, copy the rest unless working in place
+					if(r != a) while(i --> 0) r[i] = a[i];
+					break;
+				}
+			}
+			return b;
+		}
+
+		inline constexpr uint64_t sub_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b)
+		{
+			for(size_t i=n;i --> 0;) {
+				const uint64_t ai = a[i];
+				r[i] = ai - b;
+				b = ai < b;
+				if(b == 0) { // nothing left to borrow, copy the rest unless working in place
+					if(r != a) while(i --> 0) r[i] = a[i];
+					break;
+				}
+			}
+			return b;
+		}
+
+		inline constexpr uint64_t add(uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b, size_t bn)
+		{
+			const size_t diff = an-bn; // b lines up with the low bn limbs of a
+			const uint64_t carry = add_n(r+diff, a+diff, b, bn);
+			return add_1(r, a, diff, carry);
+		}
+
+		inline constexpr uint64_t sub(uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b, size_t bn)
+		{
+			const size_t diff = an-bn;
+			const uint64_t borrow = sub_n(r+diff, a+diff, b, bn);
+			return sub_1(r, a, diff, borrow);
+		}
+
+		inline constexpr uint64_t mul_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b)
+		{
+			uint64_t carry = 0;
+			for(size_t i=n;i --> 0;) {
+				__uint128_t t = (__uint128_t)a[i]*b + carry;
+				r[i] = (uint64_t)t;
+				carry = t >> 64;
+			}
+			return carry;
+		}
+
+		inline constexpr uint64_t addmul_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b)
+		{
+#if defined(__x86_64__)
+			if !consteval {
+				if(active_kernels == kernel_set::mulx_adx) return addmul_1_mulx(r, a, n, b);
+			}
+#endif
+			uint64_t carry = 0;
+			for(size_t i=n;i --> 0;) {
+				// a*b + r + carry <= (2^64-1)^2 + 2(2^64-1) = 2^128-1, can't overflow
+				__uint128_t t = (__uint128_t)a[i]*b + r[i] + carry;
+				r[i] = (uint64_t)t;
+				carry = t >> 64;
+			}
+			return carry;
+		}
+
+		inline uint64_t addmul_1_mulx(uint64_t *r, const uint64_t *a, size_t n, uint64_t b)
+		{
+#if defined(__x86_64__)
+			// limb i: lo + hi(i+1) runs on the CF chain (adcx) and + r[i] on the OF chain (adox), so the two
+			// additions don't wait on each other. lea and jrcxz leave both flags alone between limbs.
+			// The n%4 low limbs go first, then the rest four at a time
+			uint64_t carry = 0, lo0, hi0, lo1, zero;
+			const uint64_t *ap = a+n;
+			uint64_t *rp = r+n;
+			size_t count;
+			__asm__ volatile( // volatile, callers may ignore the carry but the stores to r still have to happen
+				"xor %[zero], %[zero]\n\t" // clears CF and OF
+				"mov %[rem], %[count]\n\t"
+				"jrcxz 3f\n\t"
+				"1:\n\t"
+				"mulx -8(%[ap]), %[lo0], %[hi0]\n\t"
+				"adcx %[carry], %[lo0]\n\t"
+				"adox -8(%[rp]), %[lo0]\n\t"
+				"mov %[lo0], -8(%[rp])\n\t"
+				"mov %[hi0], %[carry]\n\t"
+				"lea -8(%[ap]), %[ap]\n\t"
+				"lea -8(%[rp]), %[rp]\n\t"
+				"lea -1(%[count]), %[count]\n\t"
+				"jrcxz 3f\n\t"
+				"jmp 1b\n\t"
+				"3:\n\t"
+				"mov %[quads], %[count]\n\t"
+				"jrcxz 5f\n\t"
+				"4:\n\t"
+				"mulx -8(%[ap]), %[lo0], %[hi0]\n\t"
+				"adcx %[carry], %[lo0]\n\t"
+				"adox -8(%[rp]), %[lo0]\n\t"
+				"mov %[lo0], -8(%[rp])\n\t"
+				"mulx -16(%[ap]), %[lo1], %[carry]\n\t"
+				"adcx %[hi0], %[lo1]\n\t"
+				"adox -16(%[rp]), %[lo1]\n\t"
+				"mov %[lo1], -16(%[rp])\n\t"
+				"mulx -24(%[ap]), %[lo0], %[hi0]\n\t"
+				"adcx %[carry], %[lo0]\n\t"
+				"adox -24(%[rp]), %[lo0]\n\t"
+				"mov %[lo0], -24(%[rp])\n\t"
+				"mulx -32(%[ap]), %[lo1], %[carry]\n\t"
+				"adcx %[hi0], %[lo1]\n\t"
+				"adox -32(%[rp]), %[lo1]\n\t"
+				"mov %[lo1], -32(%[rp])\n\t"
+				"lea -32(%[ap]), %[ap]\n\t"
+				"lea -32(%[rp]), %[rp]\n\t"
+				"lea -1(%[count]), %[count]\n\t"
+				"jrcxz 5f\n\t"
+				"jmp 4b\n\t"
+				"5:\n\t"
+				"adcx %[zero], %[carry]\n\t" // a*b + r fits in n+1 limbs, so both flags fit in the top limb
+				"adox %[zero], %[carry]"
+				: [carry] "+&r" (carry), [lo0] "=&r" (lo0), [hi0] "=&r" (hi0), [lo1] "=&r" (lo1), [zero] "=&r" (zero),
+				  [count] "=&c" (count), [ap] "+&r" (ap), [rp] "+&r" (rp)
+				: [rem] "r" (n%4), [quads] "r" (n/4), "d" (b)
+				: "cc", "memory");
+			return carry;
+#else
+			return addmul_1(r, a, n, b);
+#endif
+		}
+
+		inline constexpr void mul_basecase(uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b, size_t bn)
+		{
+			const size_t rn = an+bn;
+
+			// first row initializes the result, so r doesn't have to be zeroed
+			for(size_t i=0;i+1<bn;i++) r[i] = 0;
+			r[bn-1] = mul_1(r+bn, a, an, b[bn-1]);
+
+			// every other row j accumulates a*b[j] into the window of weights j..j+an-1
+			for(size_t j=1;j<bn;j++) {
+				const uint64_t bj = b[bn-1-j];
+				uint64_t *window = r+rn-an-j;
+				window[-1] = bj == 0 ? 0 : addmul_1(window, a, an, bj);
+			}
+		}
+
+		inline constexpr void mullo_basecase(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n)
+		{
+			mul_1(r, a, n, b[n-1]);
+
+			// row j only affects weights j..n-1, the carry out of the top limb is discarded
+			for(size_t j=1;j<n;j++) {
+				const uint64_t bj = b[n-1-j];
+				if(bj != 0) addmul_1(r, a+j, n-j, bj);
+			}
+		}
+
+		inline constexpr void sqr_basecase(uint64_t *r, const uint64_t *a, size_t n)
+		{
+			const size_t rn = 2*n;
+			r[0] = r[rn-1] = 0; // the only weights (2n-1 and 0) no row of the triangle writes
+
+			// row i multiplies the limb with weight i by the limbs above it into weights 2i+1..n+i-1, the carry goes
+			// to weight n+i which no earlier row has written
+			if(n > 1) r[n-1] = mul_1(r+n, a, n-1, a[n-1]);
+			for(size_t i=1;i+1<n;i++) {
+				uint64_t *window = r+n-i;
+				window[-1] = addmul_1(window, a, n-1-i, a[n-1-i]);
+			}
+
+			// r = 2*r + a[i]^2 at weights 2i and 2i+1, shifting and adding in one pass from the bottom
+			uint64_t shift_in = 0, carry = 0;
+			for(size_t i=0;i<n;i++) {
+				const uint64_t ai = a[n-1-i];
+				const __uint128_t sq = (__uint128_t)ai*ai;
+				uint64_t *pair = r+rn-2-2*i; // pair[1] has weight 2i, pair[0] 2i+1
+				const uint64_t lo = pair[1] << 1 | shift_in, hi = pair[0] << 1 | pair[1] >> 63;
+				shift_in = pair[0] >> 63;
+				__uint128_t t = (__uint128_t)lo + (uint64_t)sq + carry;
+				pair[1] = (uint64_t)t;
+				t = (__uint128_t)hi + (uint64_t)(sq >> 64) + (uint64_t)(t >> 64);
+				pair[0] = (uint64_t)t;
+				carry = t >> 64;
+			}
+		}
+
+		inline constexpr uint64_t submul_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b)
+		{
+			uint64_t borrow = 0;
+			for(size_t i=n;i --> 0;) {
+				const __uint128_t t = (__uint128_t)a[i]*b + borrow;
+				const uint64_t lo = (uint64_t)t, ri = r[i];
+				r[i] = ri - lo;
+				borrow = (uint64_t)(t >> 64) + (ri < lo);
+			}
+			return borrow;
+		}
+
+		inline constexpr uint64_t lshift(uint64_t *r, const uint64_t *a, size_t n, unsigned shift)
+		{
+			if(shift == 0) {
+				std::copy(a, a+n, r);
+				return 0;
+			}
+			const uint64_t out = a[0] >> (64-shift);
+			for(size_t i=0;i<n-1;i++) r[i] = (a[i] << shift) | (a[i+1] >> (64-shift));
+			r[n-1] = a[n-1] << shift;
+			return out;
+		}
+
+		inline constexpr uint64_t rshift(uint64_t *r, const uint64_t *a, size_t n, unsigned shift)
+		{
+			if(shift == 0) {
+				std::copy(a, a+n, r);
+				return 0;
+			}
+			const uint64_t out = a[n-1] << (64-shift);
+			for(size_t i=n;i --> 1;) r[i] = (a[i] >> shift) | (a[i-1] << (64-shift));
+			r[0] = a[0] >> shift;
+			return out;
+		}
+
+		inline constexpr uint64_t div_128_64(uint64_t hi, uint64_t lo, uint64_t d, uint64_t &rem)
+		{
+			#if defined(__x86_64__)
+			if !consteval {
+				// hi < d so the quotient fits in 64 bits and divq can't fault
+				uint64_t q;
+				asm("divq %4" : "=a"(q), "=d"(rem) : "a"(lo), "d"(hi), "rm"(d));
+				return q;
+			}
+			#endif
+			const __uint128_t num = ((__uint128_t)hi << 64) | lo;
+			const uint64_t q = num/d;
+			rem = lo - q*d;
+			return q;
+		}
+
+		inline constexpr uint64_t divrem_1(uint64_t *q, const uint64_t *a, size_t n, uint64_t d)
+		{
+			uint64_t rem = 0;
+			for(size_t i=0;i<n;i++) {
+				const uint64_t qi = div_128_64(rem, a[i], d, rem);
+				if(q) q[i] = qi;
+			}
+			return rem;
+		}
+
+		inline constexpr void divrem(uint64_t *q, uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b, size_t bn, uint64_t *scratch)
+		{
+			// significant limbs only
+			size_t az = 0, bz = 0;
+			while(az < an && a[az] == 0) az++;
+			while(b[bz] == 0) bz++;
+			const uint64_t *ah = a+az, *bh = b+bz;
+			const size_t na = an-az, nb = bn-bz;
+			if(q) std::fill(q, q+an, 0);
+
+			// a < b: quotient is zero and remainder is a
+			if(na < nb || (na == nb && cmp(ah, bh, na) < 0)) {
+				if(r) {
+					std::fill(r, r+bn-na, 0);
+					std::copy(ah, ah+na, r+bn-na);
+				}
+				return;
+			}
+
+			// single limb divisor
+			if(nb == 1) {
+				const uint64_t rem = divrem_1(q ? q+az : nullptr, ah, na, bh[0]);
+				if(r) {
+					std::fill(r, r+bn-1, 0);
+					r[bn-1] = rem;
+				}
+				return;
+			}
+
+			// normalize so that the top bit of the divisor is set, the quotient digit estimates are then off by at most 2
+			const unsigned shift = std::countl_zero(bh[0]);
+			uint64_t *un = scratch, *vn = scratch+na+1;
+			lshift(vn, bh, nb, shift);
+			un[0] = lshift(un+1, ah, na, shift);
+
+			uint64_t *qh = q ? q+an-(na-nb+1) : nullptr; // quotient has na-nb+1 significant limbs
+			for(size_t j=0;j<=na-nb;j++) {
+				// estimate the quotient digit from the top two limbs of the window and the top limb of the divisor
+				uint64_t qhat, rhat;
+				bool rhat_overflow;
+				if(un[j] >= vn[0]) {
+					qhat = UINT64_MAX;
+					rhat = un[j+1] + vn[0];
+					rhat_overflow = rhat < vn[0];
+				} else {
+					qhat = div_128_64(un[j], un[j+1], vn[0], rhat);
+					rhat_overflow = false;
+				}
+
+				// refine with the second divisor limb
+				while(!rhat_overflow && (__uint128_t)qhat*vn[1] > (((__uint128_t)rhat << 64) | un[j+2])) {
+					qhat--;
+					rhat += vn[0];
+					rhat_overflow = rhat < vn[0];
+				}
+
+				// window -= qhat*divisor, add back once if qhat was still one too large
+				const uint64_t borrow = submul_1(un+j+1, vn, nb, qhat);
+				const uint64_t top = un[j];
+				un[j] = top - borrow;
+				if(top < borrow) {
+					qhat--;
+					un[j] += add_n(un+j+1, un+j+1, vn, nb);
+				}
+				if(qh) qh[j] = qhat;
+			}
+
+			// remainder is the low nb limbs of un, denormalized
+			if(r) {
+				std::fill(r, r+bn-nb, 0);
+				rshift(r+bn-nb, un+na-nb+1, nb, shift);
+			}
+		}
+
+		inline constexpr size_t bit_length(const uint64_t *a, size_t n)
+		{
+			for(size_t i=0;i<n;i++) {
+				if(a[i] != 0) return (n-i)*64 - std::countl_zero(a[i]);
+			}
+			return 0;
+		}
+
+		inline constexpr bool set_str_pow2(uint64_t *r, size_t n, const char *str, size_t len, unsigned bits)
+		{
+			std::fill(r, r+n, 0);
+			size_t i = len; // digits left, consumed from the least significant end
+
+			// hex fills whole limbs from 16 digits at a time
+			if(bits == 4) {
+				for(size_t q=0;i>0;q++) {
+					const size_t count = std::min<size_t>(i, 16);
+					uint64_t v = 0;
+					for(size_t j=i-count;j<i;j++) v = (v << 4) | digit_values[(unsigned char)str[j]];
+					i -= count;
+					if(v == 0) continue;
+					if(q >= n) return false;
+					r[n-1-q] = v;
+				}
+				return true;
+			}
+
+			for(size_t pos=0;i --> 0;pos+=bits) {
+				const uint64_t d = digit_values[(unsigned char)str[i]];
+				if(d == 0) continue;
+				const size_t q = pos/64, s = pos%64;
+				if(q >= n) return false;
+				r[n-1-q] |= d << s;
+				if(s+bits > 64) { // digit straddles two limbs
+					if(q+1 < n) r[n-2-q] |= d >> (64-s);
+					else if(d >> (64-s)) return false;
+				}
+			}
+			return true;
+		}
+
+		inline constexpr size_t str_size_pow2(const uint64_t *a, size_t n, unsigned bits)
+		{
+			const size_t len = (bit_length(a, n)+bits-1)/bits;
+			return len == 0 ? 1 : len;
+		}
+
+		inline constexpr size_t get_str_pow2(char *str, const uint64_t *a, size_t n, unsigned bits)
+		{
+			constexpr const char digits[] = "0123456789abcdef";
+			const size_t len = str_size_pow2(a, n, bits);
+			const uint64_t mask = (uint64_t(1) << bits)-1;
+
+			// hex writes two digits per byte of the limb
+			if(bits == 4) {
+				constexpr const std::array<char, 512> pairs = [digits]() {
+					std::array<char, 512> table{};
+					for(size_t b=0;b<256;b++) table[2*b] = digits[b >> 4], table[2*b+1] = digits[b & 15];
+					return table;
+				}();
+				size_t i = len; // characters left to write, from the least significant end
+				for(size_t q=0;i>0;q++) {
+					uint64_t v = a[n-1-q];
+					for(size_t b=0;b<8 && i>0;b++, v >>= 8) {
+						str[--i] = pairs[2*(v & 0xff)+1];
+						if(i > 0) str[--i] = pairs[2*(v & 0xff)]; // the leading digit can be half a byte
+					}
+				}
+				return len;
+			}
+
+			for(size_t k=0;k<len;k++) {
+				const size_t pos = (len-1-k)*bits, q = pos/64, s = pos%64;
+				uint64_t v = a[n-1-q] >> s;
+				if(s+bits > 64 && q+1 < n) v |= a[n-2-q] << (64-s);
+				str[k] = digits[v & mask];
+			}
+			return len;
+		}
+
+		// 8 big-endian bytes as one word: a single load and bswap at run time
+		inline constexpr uint64_t load_be64(const std::byte *bytes)
+		{
+			if !consteval {
+				uint64_t v;
+				std::memcpy(&v, bytes, 8);
+				return std::endian::native == std::endian::little ? std::byteswap(v) : v;
+			}
+			uint64_t v = 0;
+			for(size_t i=0;i<8;i++) v = v << 8 | uint64_t(bytes[i]);
+			return v;
+		}
+
+		inline constexpr void store_be64(std::byte *bytes, uint64_t v)
+		{
+			if !consteval {
+				if constexpr(std::endian::native == std::endian::little) v = std::byteswap(v);
+				std::memcpy(bytes, &v, 8);
+				return;
+			}
+			for(size_t i=8;i --> 0;v >>= 8) bytes[i] = std::byte(v & 0xff);
+		}
+
+		inline constexpr bool set_bytes(uint64_t *r, size_t n, const std::byte *bytes, size_t len)
+		{
+			for(;len > 8*n;bytes++, len--) {
+				if(bytes[0] != std::byte(0)) return false;
+			}
+			const size_t words = len/8, rest = len%8;
+			for(size_t i=0;i<words;i++) r[n-1-i] = load_be64(bytes+len-8*(i+1));
+			if(words < n) {
+				uint64_t top = 0;
+				for(size_t i=0;i<rest;i++) top = top << 8 | uint64_t(bytes[i]);
+				r[n-1-words] = top;
+				std::fill(r, r+n-1-words, 0);
+			}
+			return true;
+		}
+
+		inline constexpr bool get_bytes(std::byte *bytes, size_t len, const uint64_t *a, size_t n)
+		{
+			// limbs that don't fit have to be zero, so does the part of the top limb above len bytes
+			const size_t words = std::min(len/8, n), rest = len%8;
+			for(size_t i=0;i+words<n;i++) {
+				const uint64_t excess = i+words+1 == n && rest != 0 ? a[i] >> (8*rest) : a[i];
+				if(excess != 0) return false;
+			}
+			for(size_t i=0;i<words;i++) store_be64(bytes+len-8*(i+1), a[n-1-i]);
+			const size_t written = 8*words;
+			if(words < n && rest != 0) {
+				uint64_t top = a[n-1-words];
+				for(size_t i=len-written;i --> len-written-rest;top >>= 8) bytes[i] = std::byte(top & 0xff);
+				std::fill(bytes, bytes+len-written-rest, std::byte(0));
+			} else {
+				std::fill(bytes, bytes+len-written, std::byte(0));
+			}
+			return true;
+		}
+
+		inline constexpr uint64_t mont_n0inv(uint64_t n0)
+		{
+			// Newton iteration, every step doubles the number of correct low bits (n0*n0 = 1 mod 8 for odd n0)
+			uint64_t inv = n0;
+			for(int i=0;i<5;i++) inv *= 2 - n0*inv;
+			return -inv;
+		}
+
+		// r[k] = t[k+1] - n if that doesn't borrow, else the low k limbs of t. t holds the k+1 limbs with weights k..2k of a
+		// Montgomery reduction, less than 2n. Selected with a mask instead of a branch, t[k+1..2k] is overwritten
+		inline constexpr void mont_final_sub(uint64_t *r, uint64_t *t, const uint64_t *n, size_t k)
+		{
+			uint64_t *reduced = t+k+1; // weights below k are free now
+			const uint64_t borrow = sub_n(reduced, t+1, n, k);
+			const uint64_t mask = 0-((t[0] | (borrow ^ 1)) & 1);
+			for(size_t i=0;i<k;i++) r[i] = (reduced[i] & mask) | (t[i+1] & ~mask);
+		}
+
+		inline constexpr void mont_mul(uint64_t *r, const uint64_t *a, const uint64_t *b, const uint64_t *n, size_t k, uint64_t n0inv, uint64_t *t)
+		{
+			// t[2k+1] is used as a sliding accumulator: step i works on the k+2 limbs with weights i..i+k+1,
+			// the limb with weight i is zero after the reduction so the window moves up instead of shifting t
+			std::fill(t, t+2*k+1, 0);
+			for(size_t i=0;i<k;i++) {
+				uint64_t *window = t+k+1-i; // weights i..i+k-1
+				uint64_t *top = window-2; // weights i+k+1 and i+k
+
+				// t += a[i]*b
+				uint64_t carry = addmul_1(window, b, k, a[k-1-i]);
+				top[1] += carry;
+				top[0] += top[1] < carry;
+
+				// t += m*n, the limb with weight i becomes zero
+				const uint64_t m = window[k-1]*n0inv;
+				carry = addmul_1(window, n, k, m);
+				top[1] += carry;
+				top[0] += top[1] < carry;
+			}
+
+			mont_final_sub(r, t, n, k);
+		}
+
+		inline constexpr void mont_sqr(uint64_t *r, const uint64_t *a, const uint64_t *n, size_t k, uint64_t n0inv, uint64_t *t)
+		{
+			// a^2 in t[1..2k], the same layout mont_mul reduces in
+			sqr_basecase(t+1, a, k);
+
+			// step i makes the limb with weight i zero and adds its carry at weight i+k. The overflow of that addition
+			// goes to weight i+k+1, where step i+1 adds its own carry, so no carry chain runs to the top
+			uint64_t overflow = 0;
+			for(size_t i=0;i<k;i++) {
+				uint64_t *window = t+k+1-i; // weights i..i+k-1
+				const uint64_t m = window[k-1]*n0inv;
+				const uint64_t carry = addmul_1(window, n, k, m);
+				const __uint128_t sum = (__uint128_t)window[-1] + carry + overflow;
+				window[-1] = (uint64_t)sum;
+				overflow = sum >> 64;
+			}
+			t[0] = overflow;
+			mont_final_sub(r, t, n, k);
+		}
+
+		inline constexpr size_t mul_n_scratch_size(size_t n)
+		{
+			if(n < karatsuba_threshold) return 0;
+			if(n < toom3_threshold) {
+				const size_t h = n/2, l = n-h;
+				return 6*l+1 + std::max(mul_n_scratch_size(l), mul_n_scratch_size(h));
+			}
+			const size_t k = (n+2)/3, m = k+1;
+			return 18*m + std::max({mul_n_scratch_size(m), mul_n_scratch_size(k), mul_n_scratch_size(n-2*k)});
+		}
+
+		inline constexpr size_t sqr_n_scratch_size(size_t n)
+		{
+			if(n < sqr_karatsuba_threshold) return 0;
+			if(n < sqr_toom3_threshold) {
+				const size_t l = n-n/2;
+				return 5*l+1 + sqr_n_scratch_size(l);
+			}
+			const size_t k = (n+2)/3, m = k+1;
+			return 14*m + std::max({sqr_n_scratch_size(m), sqr_n_scratch_size(k), sqr_n_scratch_size(n-2*k)});
+		}
+
+		inline constexpr size_t mullo_n_scratch_size(size_t n)
+		{
+			return n < mullo_threshold ? 0 : 2*n + mul_n_scratch_size(n);
+		}
+
+		inline constexpr size_t mul_n_scratch_size_upto(size_t n)
+		{
+			size_t size = 0;
+			for(size_t i=karatsuba_threshold;i<=n;i++) size = std::max(size, mul_n_scratch_size(i));
+			return size;
+		}
+
+		inline constexpr size_t sqr_n_scratch_size_upto(size_t n)
+		{
+			size_t size = 0;
+			for(size_t i=sqr_karatsuba_threshold;i<=n;i++) size = std::max(size, sqr_n_scratch_size(i));
+			return size;
+		}
+
+		inline constexpr size_t mul_scratch_size_upto(size_t n)
+		{
+			// an unbalanced product takes 2*bn per step plus a balanced one, and the remainders of an/bn, bn/rem, ...
+			// at least halve every two steps, so the steps add up to less than 8*bn
+			return 8*n + mul_n_scratch_size_upto(n);
+		}
+
+		inline constexpr size_t mul_scratch_size(size_t an, size_t bn)
+		{
+			if(an < bn) std::swap(an, bn);
+			if(bn < karatsuba_threshold) return 0;
+			if(an == bn) return mul_n_scratch_size(bn);
+			const size_t rem = an%bn;
+			return 2*bn + std::max(mul_n_scratch_size(bn), rem == 0 ? 0 : mul_scratch_size(bn, rem));
+		}
+
+		// d[l] = |x1[l] - x0[h]| where l >= h, returns true if x1 < x0
+		inline constexpr bool abs_diff(uint64_t *d, const uint64_t *x1, size_t l, const uint64_t *x0, size_t h)
+		{
+			const size_t diff = l-h;
+			for(size_t i=0;i<diff;i++) {
+				if(x1[i] != 0) {
+					sub(d, x1, l, x0, h);
+					return false;
+				}
+			}
+			for(size_t i=0;i<diff;i++) d[i] = 0;
+			if(cmp(x1+diff, x0, h) >= 0) {
+				sub_n(d+diff, x1+diff, x0, h);
+				return false;
+			}
+			sub_n(d+diff, x0, x1+diff, h);
+			return true;
+		}
+
+		// r[rn] += x[xn]*2^(64*off), limbs of x that land above r are expected to be zero
+		inline constexpr void add_at(uint64_t *r, size_t rn, const uint64_t *x, size_t xn, size_t off)
+		{
+			const size_t len = std::min(xn, rn-off);
+			uint64_t *window = r+rn-off-len;
+			const uint64_t carry = add_n(window, window, x+xn-len, len);
+			add_1(r, r, rn-off-len, carry);
+		}
+
+		inline void mul_karatsuba(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n, uint64_t *scratch)
+		{
+			// high halves have l limbs and low halves have h limbs
+			const size_t h = n/2, l = n-h;
+			const uint64_t *a1 = a, *a0 = a+l, *b1 = b, *b0 = b+l;
+			uint64_t *da = scratch, *db = da+l, *zm = db+l, *t = zm+2*l, *next = t+2*l+1;
+
+			// z2 = a1*b1 in the top 2l limbs of r and z0 = a0*b0 in the low 2h limbs
+			mul_n(r, a1, b1, l, next);
+			mul_n(r+2*l, a0, b0, h, next);
+
+			// zm = |a1-a0|*|b1-b0|, subtractive form so that no operand grows by a carry limb
+			const bool neg = abs_diff(da, a1, l, a0, h) ^ abs_diff(db, b1, l, b0, h);
+			mul_n(zm, da, db, l, next);
+
+			// t = z2 + z0 - (a1-a0)(b1-b0) = a1*b0 + a0*b1
+			t[0] = add(t+1, r, 2*l, r+2*l, 2*h);
+			if(neg) t[0] += add_n(t+1, t+1, zm, 2*l);
+			else t[0] -= sub_n(t+1, t+1, zm, 2*l);
+
+			// r += t*2^(64h)
+			add_at(r, 2*n, t, 2*l+1, h);
+		}
+
+		// evaluate x[n] = x2*B^2k + x1*B^k + x0 at 1, -1 and -2. Results are two's complement with k+1 limbs
+		inline constexpr void toom3_eval(uint64_t *p1, uint64_t *pm1, uint64_t *pm2, const uint64_t *x, size_t n, size_t k)
+		{
+			const size_t s = n-2*k, m = k+1;
+			const uint64_t *x2 = x, *x1 = x+s, *x0 = x+s+k;
+
+			// p1 = x0 + x2, pm1 = x0 + x2 - x1, p1 = x0 + x2 + x1
+			p1[0] = add(p1+1, x0, k, x2, s);
+			sub(pm1, p1, m, x1, k);
+			add(p1, p1, m, x1, k);
+
+			// pm2 = 2*(pm1 + x2) - x0
+			add(pm2, pm1, m, x2, s);
+			for(size_t i=0;i<m-1;i++) pm2[i] = (pm2[i] << 1) | (pm2[i+1] >> 63);
+			pm2[m-1] <<= 1;
+			sub(pm2, pm2, m, x0, k);
+		}
+
+		// r[n] = -a[n] mod 2^(64n)
+		inline constexpr void neg_n(uint64_t *r, const uint64_t *a, size_t n)
+		{
+			uint64_t carry = 1;
+			for(size_t i=n;i --> 0;) {
+				r[i] = ~a[i] + carry;
+				carry &= r[i] == 0;
+			}
+		}
+
+		// w[2m] = x[m]*y[m] for two's complement operands, tx and ty are m limb temporaries
+		inline void toom3_mul_signed(uint64_t *w, const uint64_t *x, const uint64_t *y, size_t m,
+		                             uint64_t *tx, uint64_t *ty, uint64_t *next)
+		{
+			const bool nx = x[0] >> 63, ny = y[0] >> 63;
+			if(nx) neg_n(tx, x, m);
+			else std::copy(x, x+m, tx);
+			if(ny) neg_n(ty, y, m);
+			else std::copy(y, y+m, ty);
+			mul_n(w, tx, ty, m, next);
+			if(nx != ny) neg_n(w, w, 2*m);
+		}
+
+		// r[n] = a[n]/3 for an exact multiple of 3 in two's complement (Hensel division by the inverse of 3)
+		inline constexpr void divexact_by3(uint64_t *r, const uint64_t *a, size_t n)
+		{
+			constexpr const uint64_t inv3 = 0xaaaaaaaaaaaaaaabULL; // 3*inv3 = 1 mod 2^64
+			uint64_t borrow = 0;
+			for(size_t i=n;i --> 0;) {
+				const uint64_t ai = a[i];
+				const uint64_t c = ai < borrow;
+				const uint64_t q = (ai-borrow)*inv3;
+				r[i] = q;
+				borrow = (uint64_t)(((__uint128_t)q*3) >> 64) + c;
+			}
+		}
+
+		// r[n] = a[n]/2 for an even two's complement number
+		inline constexpr void rshift1_signed(uint64_t *r, const uint64_t *a, size_t n)
+		{
+			for(size_t i=n;i --> 1;) r[i] = (a[i] >> 1) | (a[i-1] << 63);
+			r[0] = (uint64_t)((int64_t)a[0] >> 1);
+		}
+
+		// r[2n] from the five point values of w = 2(k+1) limbs each (w0 and winf right aligned), w1, wm1 and wm2 are overwritten
+		inline constexpr void toom3_interpolate(uint64_t *r, size_t n, size_t k, uint64_t *w0, uint64_t *w1, uint64_t *wm1,
+		                                        uint64_t *wm2, const uint64_t *winf)
+		{
+			const size_t s = n-2*k, w = 2*(k+1);
+
+			// interpolation (Bodrato's sequence), values stay two's complement until the end
+			sub_n(wm2, wm2, w1, w); // r3 = (w(-2) - w(1))/3
+			divexact_by3(wm2, wm2, w);
+			sub_n(w1, w1, wm1, w); // r1 = (w(1) - w(-1))/2
+			rshift1_signed(w1, w1, w);
+			sub_n(wm1, wm1, w0, w); // r2 = w(-1) - w(0)
+			sub_n(wm2, wm1, wm2, w); // r3 = (r2 - r3)/2 + 2*w(inf)
+			rshift1_signed(wm2, wm2, w);
+			add_n(wm2, wm2, winf, w);
+			add_n(wm2, wm2, winf, w);
+			add_n(wm1, wm1, w1, w); // r2 = r2 + r1 - w(inf)
+			sub_n(wm1, wm1, winf, w);
+			sub_n(w1, w1, wm2, w); // r1 = r1 - r3
+
+			// recomposition, w(0) and w(inf) don't overlap so they are copied in directly
+			const size_t rn = 2*n;
+			for(size_t i=0;i<2*s;i++) r[i] = winf[w-2*s+i];
+			for(size_t i=2*s;i<rn-2*k;i++) r[i] = 0;
+			for(size_t i=0;i<2*k;i++) r[rn-2*k+i] = w0[2+i];
+			add_at(r, rn, w1, w, k);
+			add_at(r, rn, wm1, w, 2*k);
+			add_at(r, rn, wm2, w, 3*k);
+		}
+
+		inline void mul_toom3(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n, uint64_t *scratch)
+		{
+			// x = x2*B^2k + x1*B^k + x0 where x2 has s <= k limbs
+			const size_t k = (n+2)/3, s = n-2*k, m = k+1, w = 2*m;
+			uint64_t *w0 = scratch, *w1 = w0+w, *wm1 = w1+w, *wm2 = wm1+w, *winf = wm2+w;
+			uint64_t *pa1 = winf+w, *pam1 = pa1+m, *pam2 = pam1+m;
+			uint64_t *pb1 = pam2+m, *pbm1 = pb1+m, *pbm2 = pbm1+m;
+			uint64_t *tx = pbm2+m, *ty = tx+m, *next = ty+m;
+
+			// evaluation
+			toom3_eval(pa1, pam1, pam2, a, n, k);
+			toom3_eval(pb1, pbm1, pbm2, b, n, k);
+
+			// pointwise products, all w limbs wide
+			w0[0] = w0[1] = 0;
+			mul_n(w0+2, a+s+k, b+s+k, k, next);
+			for(size_t i=0;i<w-2*s;i++) winf[i] = 0;
+			mul_n(winf+w-2*s, a, b, s, next);
+			toom3_mul_signed(w1, pa1, pb1, m, tx, ty, next);
+			toom3_mul_signed(wm1, pam1, pbm1, m, tx, ty, next);
+			toom3_mul_signed(wm2, pam2, pbm2, m, tx, ty, next);
+
+			toom3_interpolate(r, n, k, w0, w1, wm1, wm2, winf);
+		}
+
+		inline void mul_n(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n, uint64_t *scratch)
+		{
+			if(n < karatsuba_threshold) mul_basecase(r, a, n, b, n);
+			else if(n < toom3_threshold) mul_karatsuba(r, a, b, n, scratch);
+			else mul_toom3(r, a, b, n, scratch);
+		}
+
+		inline void sqr_karatsuba(uint64_t *r, const uint64_t *a, size_t n, uint64_t *scratch)
+		{
+			const size_t h = n/2, l = n-h;
+			const uint64_t *a1 = a, *a0 = a+l;
+			uint64_t *da = scratch, *zm = da+l, *t = zm+2*l, *next = t+2*l+1;
+
+			// z2 = a1^2 in the top 2l limbs of r and z0 = a0^2 in the low 2h limbs
+			sqr_n(r, a1, l, next);
+			sqr_n(r+2*l, a0, h, next);
+
+			// zm = (a1-a0)^2, the sign of the difference doesn't matter
+			abs_diff(da, a1, l, a0, h);
+			sqr_n(zm, da, l, next);
+
+			// t = z2 + z0 - zm = 2*a1*a0
+			t[0] = add(t+1, r, 2*l, r+2*l, 2*h);
+			t[0] -= sub_n(t+1, t+1, zm, 2*l);
+			add_at(r, 2*n, t, 2*l+1, h);
+		}
+
+		// w[2m] = x[m]^2 for a two's complement operand, tx is an m limb temporary
+		inline void toom3_sqr_signed(uint64_t *w, const uint64_t *x, size_t m, uint64_t *tx, uint64_t *next)
+		{
+			if(x[0] >> 63) neg_n(tx, x, m);
+			else std::copy(x, x+m, tx);
+			sqr_n(w, tx, m, next);
+		}
+
+		inline void sqr_toom3(uint64_t *r, const uint64_t *a, size_t n, uint64_t *scratch)
+		{
+			const size_t k = (n+2)/3, s = n-2*k, m = k+1, w = 2*m;
+			uint64_t *w0 = scratch, *w1 = w0+w, *wm1 = w1+w, *wm2 = wm1+w, *winf = wm2+w;
+			uint64_t *p1 = winf+w, *pm1 = p1+m, *pm2 = pm1+m, *tx = pm2+m, *next = tx+m;
+
+			// one evaluation, the values at -1 and -2 are squared so their signs drop out
+			toom3_eval(p1, pm1, pm2, a, n, k);
+			w0[0] = w0[1] = 0;
+			sqr_n(w0+2, a+s+k, k, next);
+			for(size_t i=0;i<w-2*s;i++) winf[i] = 0;
+			sqr_n(winf+w-2*s, a, s, next);
+			toom3_sqr_signed(w1, p1, m, tx, next);
+			toom3_sqr_signed(wm1, pm1, m, tx, next);
+			toom3_sqr_signed(wm2, pm2, m, tx, next);
+			toom3_interpolate(r, n, k, w0, w1, wm1, wm2, winf);
+		}
+
+		inline void sqr_n(uint64_t *r, const uint64_t *a, size_t n, uint64_t *scratch)
+		{
+			if(n < sqr_karatsuba_threshold) sqr_basecase(r, a, n);
+			else if(n < sqr_toom3_threshold) sqr_karatsuba(r, a, n, scratch);
+			else sqr_toom3(r, a, n, scratch);
+		}
+
+		inline void mullo_n(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n, uint64_t *scratch)
+		{
+			if(n < mullo_threshold) return mullo_basecase(r, a, b, n);
+
+			// Karatsuba/Toom-3 full product is cheaper than the truncated basecase at this size
+			mul_n(scratch, a, b, n, scratch+2*n);
+			std::copy(scratch+n, scratch+2*n, r);
+		}
+
+		inline void mul(uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b, size_t bn, uint64_t *scratch)
+		{
+			if(an < bn) {
+				std::swap(a, b);
+				std::swap(an, bn);
+			}
+			if(bn < karatsuba_threshold) return mul_basecase(r, a, an, b, bn);
+			if(an == bn) return mul_n(r, a, b, an, scratch);
+
+			// unbalanced: multiply b by bn limb blocks of a, starting from the least significant block
+			const size_t rn = an+bn;
+			uint64_t *t = scratch, *next = t+2*bn;
+			for(size_t i=0;i<an-bn;i++) r[i] = 0;
+			mul_n(r+an-bn, a+an-bn, b, bn, next);
+			for(size_t off=bn;off<an;off+=bn) {
+				const size_t len = std::min(bn, an-off);
+				mul(t, a+an-off-len, len, b, bn, next);
+				add_at(r, rn, t, len+bn, off);
+			}
+		}
+	}; /* NAMESPACE LIMB */
+}; /* NAMESPACE BIGINT */
+
+#endif /* LIMB_CPP */
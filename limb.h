@@ -0,0 +1,202 @@
+#ifndef LIMB_H
+#define LIMB_H
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <bit>
+#include <array>
+#include <cstring>
+
+// limb counts where multiplication switches algorithm, can be tuned at compile time with -D
+#ifndef BIGINT_KARATSUBA_THRESHOLD
+#define BIGINT_KARATSUBA_THRESHOLD 24 // below this, schoolbook multiplication is used
+#endif
+#ifndef BIGINT_TOOM3_THRESHOLD
+#define BIGINT_TOOM3_THRESHOLD 160 // at and above this, Toom-3 is used instead of Karatsuba
+#endif
+#ifndef BIGINT_SQR_KARATSUBA_THRESHOLD
+#define BIGINT_SQR_KARATSUBA_THRESHOLD 64 // squaring basecase does half the products, so it stays ahead for longer
+#endif
+#ifndef BIGINT_SQR_TOOM3_THRESHOLD
+#define BIGINT_SQR_TOOM3_THRESHOLD 256
+#endif
+#ifndef BIGINT_MULLO_THRESHOLD
+#define BIGINT_MULLO_THRESHOLD 192 // below this, truncated products use the basecase instead of a full product
+#endif
+
+// Low level kernels that work on raw 64-bit limb arrays. The limb order is the same as BigUint::op:
+// index 0 is the most significant limb and index n-1 is the least significant limb.
+// None of these functions allocate, the caller owns all of the buffers.
+
+namespace BigInt
+{
+	namespace limb
+	{
+		// instruction set specific kernels, picked once at startup from cpuid. The portable kernels are
+		// always used in constant evaluation
+		enum class kernel_set { portable, mulx_adx };
+
+		// best kernel set the cpu supports
+		inline kernel_set detect_kernel_set();
+
+		// kernel set used by addmul_1 and everything built on it (multiplication, Montgomery, division)
+		inline kernel_set active_kernel_set();
+
+		// switch kernel sets, returns false and keeps the current one if the cpu doesn't support ks
+		inline bool select_kernel_set(kernel_set ks);
+
+		inline constexpr const char *kernel_set_name(kernel_set ks);
+
+		constexpr const size_t karatsuba_threshold = BIGINT_KARATSUBA_THRESHOLD;
+		constexpr const size_t toom3_threshold = BIGINT_TOOM3_THRESHOLD;
+		constexpr const size_t mullo_threshold = BIGINT_MULLO_THRESHOLD;
+		constexpr const size_t sqr_karatsuba_threshold = BIGINT_SQR_KARATSUBA_THRESHOLD;
+		constexpr const size_t sqr_toom3_threshold = BIGINT_SQR_TOOM3_THRESHOLD;
+		static_assert(karatsuba_threshold >= 2 && toom3_threshold >= 7 && sqr_karatsuba_threshold >= 2 && sqr_toom3_threshold >= 7,
+		              "multiplication thresholds are too small to split operands");
+
+		// compare a[n] and b[n], returns -1, 0 or 1
+		inline constexpr int cmp(const uint64_t *a, const uint64_t *b, size_t n);
+
+		// r[n] = a[n] + b[n], returns the carry. r can be a or b
+		inline constexpr uint64_t add_n(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n);
+
+		// r[n] = a[n] - b[n], returns the borrow. r can be a or b
+		inline constexpr uint64_t sub_n(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n);
+
+		// r[n] = a[n] + b, returns the carry. r can be a
+		inline constexpr uint64_t add_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b);
+
+		// r[n] = a[n] - b, returns the borrow. r can be a
+		inline constexpr uint64_t sub_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b);
+
+		// r[an] = a[an] + b[bn] where an >= bn, returns the carry. r can be a
+		inline constexpr uint64_t add(uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b, size_t bn);
+
+		// r[an] = a[an] - b[bn] where an >= bn, returns the borrow. r can be a
+		inline constexpr uint64_t sub(uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b, size_t bn);
+
+		// r[n] = a[n]*b, returns the carry limb (the limb above r[0])
+		inline constexpr uint64_t mul_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b);
+
+		// r[n] += a[n]*b, returns the carry limb
+		inline constexpr uint64_t addmul_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b);
+
+		// r[an+bn] = a[an]*b[bn], operand scanning schoolbook multiplication. r can't overlap a or b
+		inline constexpr void mul_basecase(uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b, size_t bn);
+
+		// r[n] = (a[n]*b[n]) mod 2^(64n), only the low half of the product is calculated. r can't overlap a or b
+		inline constexpr void mullo_basecase(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n);
+
+		// r[2n] = a[n]^2. Every cross product a[i]*a[j] (i != j) is computed once and doubled with a shift, then the squares
+		// a[i]^2 are added, about half the products of mul_basecase. No branches on the limb values. r can't overlap a
+		inline constexpr void sqr_basecase(uint64_t *r, const uint64_t *a, size_t n);
+
+		// r[n] += a[n]*b with mulx and two independent adcx/adox carry chains, only valid if the cpu has BMI2 and ADX.
+		// addmul_1 forwards here when the mulx_adx kernel set is active
+		inline uint64_t addmul_1_mulx(uint64_t *r, const uint64_t *a, size_t n, uint64_t b);
+
+		// r[n] -= a[n]*b, returns the borrow limb
+		inline constexpr uint64_t submul_1(uint64_t *r, const uint64_t *a, size_t n, uint64_t b);
+
+		// r[n] = a[n] << shift for shift < 64, returns the bits shifted out of the top limb. r can be a
+		inline constexpr uint64_t lshift(uint64_t *r, const uint64_t *a, size_t n, unsigned shift);
+
+		// r[n] = a[n] >> shift for shift < 64, returns the bits shifted out of the bottom limb (in the high bits). r can be a
+		inline constexpr uint64_t rshift(uint64_t *r, const uint64_t *a, size_t n, unsigned shift);
+
+		// (hi*2^64 + lo) / d where hi < d, rem gets the remainder
+		inline constexpr uint64_t div_128_64(uint64_t hi, uint64_t lo, uint64_t d, uint64_t &rem);
+
+		// q[n] = a[n]/d, returns a[n]%d. q can be nullptr if only the remainder is needed
+		inline constexpr uint64_t divrem_1(uint64_t *q, const uint64_t *a, size_t n, uint64_t d);
+
+		// Knuth's Algorithm D: q[an] = a[an]/b[bn] and r[bn] = a[an]%b[bn], leading zero limbs of a and b are skipped.
+		// b can't be zero. q or r can be nullptr if not needed. scratch has to hold an+bn+1 limbs
+		inline constexpr void divrem(uint64_t *q, uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b, size_t bn, uint64_t *scratch);
+
+		// number of significant bits in a[n], 0 if a is zero
+		inline constexpr size_t bit_length(const uint64_t *a, size_t n);
+
+		// digit value of every character for bases up to 16 (either case), 0xff for anything else
+		inline constexpr const std::array<uint8_t, 256> digit_values = []() {
+			std::array<uint8_t, 256> table{};
+			for(auto &v : table) v = 0xff;
+			for(int c='0';c<='9';c++) table[c] = c-'0';
+			for(int c='a';c<='f';c++) table[c] = table[c-'a'+'A'] = c-'a'+10;
+			return table;
+		}();
+
+		// r[n] from len digits in base 2^bits (bits 1, 3 or 4) in str, most significant first. The digits aren't validated.
+		// Returns false if the value doesn't fit n limbs
+		inline constexpr bool set_str_pow2(uint64_t *r, size_t n, const char *str, size_t len, unsigned bits);
+
+		// number of base 2^bits digits of a[n] without leading zeros, 1 for zero
+		inline constexpr size_t str_size_pow2(const uint64_t *a, size_t n, unsigned bits);
+
+		// writes the str_size_pow2(a, n, bits) lowercase digits of a[n] in base 2^bits to str, returns the count
+		inline constexpr size_t get_str_pow2(char *str, const uint64_t *a, size_t n, unsigned bits);
+
+		// r[n] from len big-endian bytes (OS2IP), leading zero bytes beyond 8n are allowed. Returns false if the value doesn't fit n limbs
+		inline constexpr bool set_bytes(uint64_t *r, size_t n, const std::byte *bytes, size_t len);
+
+		// a[n] as exactly len big-endian bytes, zero padded (I2OSP). Returns false if the value needs more than len bytes
+		inline constexpr bool get_bytes(std::byte *bytes, size_t len, const uint64_t *a, size_t n);
+
+		// -n0^-1 mod 2^64 for an odd n0, the Montgomery reduction constant
+		inline constexpr uint64_t mont_n0inv(uint64_t n0);
+
+		// Montgomery product r[k] = a[k]*b[k]*2^(-64k) mod n[k] with interleaved (CIOS) reduction. a and b have to be less than n.
+		// The final subtraction is branch free so the run time doesn't depend on the operands. t is a 2k+1 limb temporary. r can be a or b
+		inline constexpr void mont_mul(uint64_t *r, const uint64_t *a, const uint64_t *b, const uint64_t *n, size_t k, uint64_t n0inv, uint64_t *t);
+
+		// Montgomery square r[k] = a[k]^2*2^(-64k) mod n[k], a full sqr_basecase followed by a separate (SOS) reduction.
+		// Same bounds, constant-time final subtraction and t of 2k+1 limbs as mont_mul. r can be a
+		inline constexpr void mont_sqr(uint64_t *r, const uint64_t *a, const uint64_t *n, size_t k, uint64_t n0inv, uint64_t *t);
+
+		// scratch limbs needed by mul_n, mullo_n and mul. Recursion levels share one buffer instead of allocating
+		inline constexpr size_t mul_n_scratch_size(size_t n);
+		inline constexpr size_t mullo_n_scratch_size(size_t n);
+		inline constexpr size_t mul_scratch_size(size_t an, size_t bn);
+
+		inline constexpr size_t sqr_n_scratch_size(size_t n);
+
+		// largest mul_n_scratch_size (sqr_n_scratch_size) for any size up to n, for buffers shared by operands of varying length
+		inline constexpr size_t mul_n_scratch_size_upto(size_t n);
+		inline constexpr size_t sqr_n_scratch_size_upto(size_t n);
+
+		// scratch that covers mul for any an and bn up to n
+		inline constexpr size_t mul_scratch_size_upto(size_t n);
+
+		// r[2n] = a[n]*b[n], Karatsuba on n/2 limb halves, recursing through mul_n
+		inline void mul_karatsuba(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n, uint64_t *scratch);
+
+		// r[2n] = a[n]*b[n], Toom-3 (evaluation points 0, 1, -1, -2, inf) on n/3 limb thirds, recursing through mul_n
+		inline void mul_toom3(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n, uint64_t *scratch);
+
+		// r[2n] = a[n]*b[n], selects basecase, Karatsuba or Toom-3 by n. scratch has to hold mul_n_scratch_size(n) limbs
+		inline void mul_n(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n, uint64_t *scratch);
+
+		// r[2n] = a[n]^2, Karatsuba with the middle term from (a1-a0)^2, which is never negative
+		inline void sqr_karatsuba(uint64_t *r, const uint64_t *a, size_t n, uint64_t *scratch);
+
+		// r[2n] = a[n]^2, Toom-3 with one evaluation and five squares
+		inline void sqr_toom3(uint64_t *r, const uint64_t *a, size_t n, uint64_t *scratch);
+
+		// r[2n] = a[n]^2, selects basecase, Karatsuba or Toom-3 squaring by n. scratch has to hold sqr_n_scratch_size(n) limbs
+		inline void sqr_n(uint64_t *r, const uint64_t *a, size_t n, uint64_t *scratch);
+
+		// r[n] = (a[n]*b[n]) mod 2^(64n), basecase for small n and the low half of a full product above mullo_threshold.
+		// scratch has to hold mullo_n_scratch_size(n) limbs
+		inline void mullo_n(uint64_t *r, const uint64_t *a, const uint64_t *b, size_t n, uint64_t *scratch);
+
+		// r[an+bn] = a[an]*b[bn] for any sizes. scratch has to hold mul_scratch_size(an, bn) limbs
+		inline void mul(uint64_t *r, const uint64_t *a, size_t an, const uint64_t *b, size_t bn, uint64_t *scratch);
+	}; /* NAMESPACE LIMB */
+}; /* NAMESPACE BIGINT */
+
+// include here because of inline definitions
+#include "limb.cpp"
+
+#endif /* LIMB_H */
@@ -0,0 +1,488 @@
+#ifndef MODULAR_CPP
+#define MODULAR_CPP
+
+#include <cstdint>
+#include <array>
+#include <algorithm>
+#include <utility>
+
+#include "modular.h"
+
+namespace BigInt
+{
+	template<typename uint_type>
+	MontgomeryContext<uint_type>::MontgomeryContext(const uint_type &mod) : n(mod)
+	{
+		const uint64_t *mod_op = mod.__get_op();
+		if((mod_op[op_size-1] & 1) == 0)
+			throw modulus_error("Montgomery modulus has to be odd");
+
+		k = (limb::bit_length(mod_op, op_size)+63)/64;
+		n0inv = limb::mont_n0inv(mod_op[op_size-1]);
+
+		// R^2 mod n by dividing 2^(128k)
+		std::array<uint64_t, 2*op_size+1> r2_num{};
+		std::array<uint64_t, 3*op_size+2> scratch;
+		r2_num[2*op_size-2*k] = 1;
+		r2 = 0;
+		limb::divrem(nullptr, r2.__get_op()+op_size-k, r2_num.data()+2*op_size-2*k, 2*k+1, low(n), k, scratch.data());
+
+		// R mod n = mont(R^2) since R^2*R^-1 = R
+		one_mont = from_mont(r2);
+	}
+
+	template<typename uint_type>
+	uint_type MontgomeryContext<uint_type>::to_mont(const uint_type &a) const
+	{
+		// a can be anything less than R, larger inputs are reduced by division first
+		if(limb::bit_length(a.__get_op(), op_size) > 64*k) {
+			uint_type reduced = a;
+			return mont_mul(reduced % n, r2);
+		}
+		return mont_mul(a, r2);
+	}
+
+	template<typename uint_type>
+	uint_type MontgomeryContext<uint_type>::from_mont(const uint_type &a) const
+	{
+		return mont_mul(a, uint_type(1));
+	}
+
+	template<typename uint_type>
+	uint_type MontgomeryContext<uint_type>::mont_mul(const uint_type &a, const uint_type &b) const
+	{
+		uint_type ret;
+		uint64_t *ret_op = ret.__get_op();
+		std::array<uint64_t, 2*op_size+1> t;
+		std::fill(ret_op, ret_op+op_size-k, 0);
+		limb::mont_mul(ret_op+op_size-k, low(a), low(b), low(n), k, n0inv, t.data());
+		return ret;
+	}
+
+	template<typename uint_type>
+	uint_type MontgomeryContext<uint_type>::mont_sqr(const uint_type &a) const
+	{
+		uint_type ret;
+		uint64_t *ret_op = ret.__get_op();
+		std::array<uint64_t, 2*op_size+1> t;
+		std::fill(ret_op, ret_op+op_size-k, 0);
+		limb::mont_sqr(ret_op+op_size-k, low(a), low(n), k, n0inv, t.data());
+		return ret;
+	}
+
+	template<typename uint_type>
+	uint_type MontgomeryContext<uint_type>::reduce(const uint_type &a) const
+	{
+		// Horner's rule in base R: acc = acc*R + piece mod n. mont_mul(acc, R^2) is acc*R and mont_mul(piece, R mod n)
+		// is piece mod n, both hold for a piece up to R since the other operand is less than n
+		const uint64_t *a_op = a.__get_op();
+		uint_type acc = 0;
+		for(size_t end=op_size-(op_size-1)/k*k;end<=op_size;end+=k) {
+			uint_type piece = 0;
+			const size_t start = end > k ? end-k : 0;
+			std::copy(a_op+start, a_op+end, piece.__get_op()+op_size-(end-start));
+			acc = mod_add(mont_mul(acc, r2), mont_mul(piece, one_mont));
+		}
+		return acc;
+	}
+
+	template<typename uint_type>
+	uint_type MontgomeryContext<uint_type>::mod_add(const uint_type &a, const uint_type &b) const
+	{
+		// the sum with its carry in the layout of mont_final_sub, which takes n off if that doesn't borrow
+		uint_type ret;
+		uint64_t *ret_op = ret.__get_op();
+		std::array<uint64_t, 2*op_size+1> t;
+		t[0] = limb::add_n(t.data()+1, low(a), low(b), k);
+		std::fill(ret_op, ret_op+op_size-k, 0);
+		limb::mont_final_sub(ret_op+op_size-k, t.data(), low(n), k);
+		return ret;
+	}
+
+	template<typename uint_type>
+	uint_type MontgomeryContext<uint_type>::mod_sub(const uint_type &a, const uint_type &b) const
+	{
+		uint_type ret;
+		uint64_t *ret_op = ret.__get_op();
+		std::array<uint64_t, op_size> n_masked;
+		std::fill(ret_op, ret_op+op_size-k, 0);
+		const uint64_t mask = 0-limb::sub_n(ret_op+op_size-k, low(a), low(b), k);
+		const uint64_t *n_op = low(n);
+		for(size_t i=0;i<k;i++) n_masked[i] = n_op[i] & mask;
+		limb::add_n(ret_op+op_size-k, ret_op+op_size-k, n_masked.data(), k);
+		return ret;
+	}
+
+	template<typename uint_type>
+	BarrettContext<uint_type>::BarrettContext(const uint_type &mod) : n(mod)
+	{
+		const uint64_t *mod_op = mod.__get_op();
+		const size_t bits = limb::bit_length(mod_op, op_size);
+		if(bits == 0)
+			throw modulus_error("Barrett modulus can't be zero");
+		k = (bits+63)/64;
+
+		n_ext.fill(0);
+		std::copy(mod_op+op_size-k, mod_op+op_size, n_ext.end()-k);
+
+		// mu = floor(2^(128k)/n), has k+1 limbs unless n is a power of 2^64, then it's saturated to 2^(64(k+1))-1.
+		// A smaller mu only makes the quotient estimate smaller, which the correction loop in reduce makes up for
+		std::array<uint64_t, 2*op_size+1> num{}, quotient;
+		std::array<uint64_t, 3*op_size+2> scratch;
+		const size_t num_len = 2*k+1;
+		num[0] = 1;
+		limb::divrem(quotient.data(), nullptr, num.data(), num_len, mod_op+op_size-k, k, scratch.data());
+		mu.fill(0);
+		if(std::any_of(quotient.begin(), quotient.begin()+num_len-(k+1), [](uint64_t limb) { return limb != 0; }))
+			std::fill(mu.end()-(k+1), mu.end(), UINT64_MAX);
+		else
+			std::copy(quotient.begin()+num_len-(k+1), quotient.begin()+num_len, mu.end()-(k+1));
+
+		one_mod = reduce(uint_type(1));
+	}
+
+	template<typename uint_type>
+	uint_type BarrettContext<uint_type>::reduce(const uint64_t *x, size_t xn) const
+	{
+		// x as 2k limbs, anything above is zero
+		std::array<uint64_t, 2*op_size> xw{};
+		const size_t len = std::min(xn, 2*k);
+		std::copy(x+xn-len, x+xn, xw.begin()+2*k-len);
+
+		// q3 = floor(floor(x/b^(k-1))*mu / b^(k+1)), an estimate of x/n that is at most 2 too small
+		std::array<uint64_t, 2*op_size+2> q2;
+		std::array<uint64_t, limb::mul_n_scratch_size_upto(op_size+1)> mul_scratch;
+		limb::mul_n(q2.data(), xw.data(), mu.data()+mu.size()-(k+1), k+1, mul_scratch.data());
+		const uint64_t *q3 = q2.data();
+
+		// r = (x - q3*n) mod b^(k+1), only the low k+1 limbs of either side are needed
+		std::array<uint64_t, op_size+1> r, r2;
+		std::array<uint64_t, limb::mullo_n_scratch_size(op_size+1)> mullo_scratch;
+		limb::mullo_n(r2.data(), q3, n_ext.data()+n_ext.size()-(k+1), k+1, mullo_scratch.data());
+		limb::sub_n(r.data(), xw.data()+k-1, r2.data(), k+1);
+
+		const uint64_t *nk = n_ext.data()+n_ext.size()-(k+1);
+		while(limb::cmp(r.data(), nk, k+1) >= 0) limb::sub_n(r.data(), r.data(), nk, k+1);
+
+		uint_type ret;
+		uint64_t *ret_op = ret.__get_op();
+		std::fill(ret_op, ret_op+op_size-k, 0);
+		std::copy(r.begin()+1, r.begin()+k+1, ret_op+op_size-k);
+		return ret;
+	}
+
+	template<typename uint_type>
+	uint_type BarrettContext<uint_type>::reduce(const uint_type &a) const
+	{
+		// values with more than 2k limbs are out of range for the Barrett estimate
+		if(limb::bit_length(a.__get_op(), op_size) > 128*k) {
+			uint_type reduced = a;
+			return reduced % n;
+		}
+		return reduce(a.__get_op(), op_size);
+	}
+
+	template<typename uint_type>
+	uint_type BarrettContext<uint_type>::mul(const uint_type &a, const uint_type &b) const
+	{
+		// a, b < n so the product has at most 2k limbs
+		std::array<uint64_t, 2*op_size> product;
+		std::array<uint64_t, limb::mul_n_scratch_size_upto(op_size)> scratch;
+		const uint64_t *a_op = a.__get_op()+op_size-k, *b_op = b.__get_op()+op_size-k;
+		limb::mul_n(product.data(), a_op, b_op, k, scratch.data());
+		return reduce(product.data(), 2*k);
+	}
+
+	template<typename uint_type>
+	uint_type BarrettContext<uint_type>::sqr(const uint_type &a) const
+	{
+		std::array<uint64_t, 2*op_size> product;
+		std::array<uint64_t, limb::sqr_n_scratch_size_upto(op_size)> scratch;
+		limb::sqr_n(product.data(), a.__get_op()+op_size-k, k, scratch.data());
+		return reduce(product.data(), 2*k);
+	}
+
+	template<typename uint_type>
+	uint_type mulmod(const uint_type &a, const uint_type &b, const uint_type &mod)
+	{
+		constexpr const size_t op_size = uint_type::__get_op_size();
+		if(limb::bit_length(mod.__get_op(), op_size) == 0)
+			throw division_by_zero_error("mulmod modulus is zero");
+
+		std::array<uint64_t, 2*op_size> product;
+		std::array<uint64_t, limb::mul_n_scratch_size(op_size)> mul_scratch;
+		std::array<uint64_t, 3*op_size+1> div_scratch;
+		uint_type ret;
+		limb::mul_n(product.data(), a.__get_op(), b.__get_op(), op_size, mul_scratch.data());
+		limb::divrem(nullptr, ret.__get_op(), product.data(), 2*op_size, mod.__get_op(), op_size, div_scratch.data());
+		ret.normalize();
+		return ret;
+	}
+
+	// Lehmer's algorithm on u and v. With cofactors it also keeps u = s0*a + t0*b and v = s1*a + t1*b for the starting
+	// values a and b. The cofactors are magnitudes with alternating signs: s0 and t1 are >= 0 and s1 and t0 <= 0 while odd
+	// is false, the other way around while it's true. Magnitudes never exceed b (a), so the wrapping operators are exact
+	template<bool with_cofactors, typename uint_type>
+	void lehmer_gcd(uint_type &u, uint_type &v, uint_type &s0, uint_type &s1, uint_type &t0, uint_type &t1, bool &odd)
+	{
+		constexpr const size_t op_size = uint_type::__get_op_size();
+
+		// 63 bits of x from bit shift up, through the const op so the significant limb count is kept
+		auto top_bits = [](const uint_type &x, size_t shift) -> uint64_t {
+			const uint64_t *op = x.__get_op();
+			const size_t i = op_size-1-shift/64, s = shift%64;
+			uint64_t w = op[i] >> s;
+			if(s != 0 && i > 0) w |= op[i-1] << (64-s);
+			return w & (UINT64_MAX >> 1);
+		};
+
+		// one step of Euclid's algorithm with a full division, for quotients the single words can't determine
+		auto euclid_step = [&]() {
+			auto [q, r] = u.divmod(v);
+			u = v;
+			v = r;
+			if constexpr(with_cofactors) {
+				uint_type s = s0 + q*s1, t = t0 + q*t1;
+				s0 = s1;
+				s1 = s;
+				t0 = t1;
+				t1 = t;
+				odd = !odd;
+			}
+		};
+
+		if(u < v) { // a quotient of 0 swaps them
+			std::swap(u, v);
+			std::swap(s0, s1);
+			std::swap(t0, t1);
+			odd = !odd;
+		}
+		while(!v.is_zero()) {
+			// Knuth's Algorithm L: the quotients of (uh+A)/(vh+C) and (uh+B)/(vh+D) bracket the true one, so while they agree
+			// it's known without looking at the low bits. A, B, C, D are the cosequence of the quotients so far
+			const size_t bits = limb::bit_length(std::as_const(u).__get_op(), op_size);
+			const size_t shift = bits > 63 ? bits-63 : 0;
+			__int128 uh = top_bits(u, shift), vh = top_bits(v, shift), A = 1, B = 0, C = 0, D = 1, T;
+			size_t steps = 0;
+			while(vh+C != 0 && vh+D != 0) {
+				const __int128 q = (uh+A)/(vh+C);
+				if(q != (uh+B)/(vh+D)) break;
+				T = A-q*C; A = C; C = T;
+				T = B-q*D; B = D; D = T;
+				T = uh-q*vh; uh = vh; vh = T;
+				steps++;
+			}
+			if(steps == 0) {
+				euclid_step();
+				continue;
+			}
+
+			// the signs of A, B, C, D follow the step count, A and D have the sign of (-1)^steps and B and C the other one
+			uint_type ma = uint64_t(A < 0 ? -A : A), mb = uint64_t(B < 0 ? -B : B);
+			uint_type mc = uint64_t(C < 0 ? -C : C), md = uint64_t(D < 0 ? -D : D);
+			uint_type au = u*ma, bv = v*mb, cu = u*mc, dv = v*md;
+			if(steps%2 == 0) {
+				u = au-bv;
+				v = dv-cu;
+			} else {
+				u = bv-au;
+				v = cu-dv;
+			}
+			if constexpr(with_cofactors) {
+				uint_type s = s0*ma + s1*mb, t = t0*ma + t1*mb;
+				s1 = s0*mc + s1*md;
+				t1 = t0*mc + t1*md;
+				s0 = s;
+				t0 = t;
+				if(steps%2 != 0) odd = !odd;
+			}
+		}
+	}
+
+	template<typename uint_type>
+	uint_type gcd(const uint_type &a, const uint_type &b)
+	{
+		uint_type u = a, v = b, unused;
+		bool odd = false;
+		lehmer_gcd<false>(u, v, unused, unused, unused, unused, odd);
+		return u;
+	}
+
+	template<typename uint_type>
+	uint_type lcm(const uint_type &a, const uint_type &b)
+	{
+		if(a.is_zero() || b.is_zero()) return 0;
+		uint_type reduced = a;
+		return (reduced/gcd(a, b))*b;
+	}
+
+	template<typename uint_type>
+	ext_gcd_result<uint_type> ext_gcd(const uint_type &a, const uint_type &b)
+	{
+		// a*x - b*y = b has no non-negative solution
+		if(a.is_zero()) return {b, 0, 0};
+
+		uint_type u = a, v = b, s0 = 1, s1 = 0, t0 = 0, t1 = 1;
+		bool odd = false;
+		lehmer_gcd<true>(u, v, s0, s1, t0, t1, odd);
+		if(!odd) return {u, s0, t0};
+
+		// u = t0*b - s0*a, and s1 = b/u, t1 = a/u since 0 = t1*a - s1*b. Adding that zero makes both cofactors positive
+		return {u, s1-s0, t1-t0};
+	}
+
+	template<typename uint_type>
+	uint_type mod_inverse(const uint_type &a, const uint_type &mod)
+	{
+		if(mod.is_zero())
+			throw division_by_zero_error("mod_inverse modulus is zero");
+
+		uint_type reduced = a;
+		reduced %= mod;
+		const ext_gcd_result<uint_type> r = ext_gcd(reduced, mod);
+		if(!r.gcd.is_one())
+			throw not_invertible_error("mod_inverse value and modulus aren't coprime");
+		return r.x;
+	}
+
+	inline constexpr unsigned powmod_window_bits(size_t exp_bits)
+	{
+		if(exp_bits > 671) return 6;
+		if(exp_bits > 239) return 5;
+		if(exp_bits > 79) return 4;
+		if(exp_bits > 23) return 3;
+		if(exp_bits > 6) return 2;
+		return 1;
+	}
+
+	template<typename uint_type, typename context_type>
+	uint_type powmod(const uint_type &base, const uint_type &exp, const context_type &ctx)
+	{
+		constexpr const size_t op_size = uint_type::__get_op_size();
+		const uint64_t *e = exp.__get_op();
+		const size_t bits = limb::bit_length(e, op_size);
+		auto bit = [e](size_t i) -> unsigned { return (e[op_size-1-i/64] >> (i%64)) & 1; };
+		if(bits == 0) return ctx.from_domain(ctx.one());
+
+		// odd powers x, x^3, x^5, ..., x^(2^w-1)
+		const unsigned w = powmod_window_bits(bits);
+		std::array<uint_type, 1 << (powmod_window_bits(SIZE_MAX)-1)> table;
+		table[0] = ctx.to_domain(base);
+		if(w > 1) {
+			const uint_type x2 = ctx.sqr(table[0]);
+			for(size_t i=1;i<(1u << (w-1));i++) table[i] = ctx.mul(table[i-1], x2);
+		}
+
+		// scan from the top bit. A window starts at a set bit and ends at the lowest set bit within w bits,
+		// so every window value is odd and comes straight from the table
+		uint_type acc;
+		bool first = true;
+		size_t i = bits;
+		while(i > 0) {
+			if(!bit(i-1)) {
+				acc = ctx.sqr(acc);
+				i--;
+				continue;
+			}
+			size_t low = i > w ? i-w : 0;
+			while(!bit(low)) low++;
+			size_t value = 0;
+			for(size_t j=i;j --> low;) value = (value << 1) | bit(j);
+
+			if(first) {
+				acc = table[value >> 1];
+				first = false;
+			} else {
+				for(size_t j=low;j<i;j++) acc = ctx.sqr(acc);
+				acc = ctx.mul(acc, table[value >> 1]);
+			}
+			i = low;
+		}
+		return ctx.from_domain(acc);
+	}
+
+	template<typename uint_type>
+	uint_type powmod(const uint_type &base, const uint_type &exp, const uint_type &mod)
+	{
+		if(limb::bit_length(mod.__get_op(), uint_type::__get_op_size()) == 0)
+			throw division_by_zero_error("powmod modulus is zero");
+
+		if(mod.__get_op()[uint_type::__get_op_size()-1] & 1)
+			return powmod(base, exp, MontgomeryContext<uint_type>(mod));
+		return powmod(base, exp, BarrettContext<uint_type>(mod));
+	}
+
+	inline constexpr unsigned powmod_ct_window_bits(size_t mod_bits)
+	{
+		return mod_bits > 768 ? 5 : 4;
+	}
+
+	template<typename uint_type>
+	uint_type powmod_ct(const uint_type &base, const uint_type &exp, const MontgomeryContext<uint_type> &ctx)
+	{
+		constexpr const size_t op_size = uint_type::__get_op_size();
+		constexpr const size_t max_entries = 1 << powmod_ct_window_bits(SIZE_MAX);
+		const size_t k = ctx.limbs();
+		const unsigned w = powmod_ct_window_bits(64*k);
+		const size_t entries = 1 << w;
+
+		// table of x^0..x^(2^w-1) in Montgomery form. Limb j of every power is stored next to each other
+		// (table[j*entries + i]), so a lookup reads the same cache lines whatever the index is
+		alignas(64) std::array<uint64_t, max_entries*op_size> table;
+		auto scatter = [&](const uint_type &v, size_t i) {
+			const uint64_t *v_op = v.__get_op()+op_size-k;
+			for(size_t j=0;j<k;j++) table[j*entries+i] = v_op[j];
+		};
+		auto gather = [&](uint_type &v, size_t index) {
+			uint64_t *v_op = v.__get_op();
+			std::fill(v_op, v_op+op_size-k, 0);
+			v_op += op_size-k;
+			for(size_t j=0;j<k;j++) {
+				uint64_t limb = 0;
+				for(size_t i=0;i<entries;i++) {
+					const uint64_t diff = i ^ index;
+					const uint64_t mask = ((diff | (0-diff)) >> 63) - 1; // all ones if i == index
+					limb |= table[j*entries+i] & mask;
+				}
+				v_op[j] = limb;
+			}
+		};
+
+		const uint_type x = ctx.to_mont(base);
+		uint_type power = ctx.mont_one();
+		scatter(power, 0);
+		for(size_t i=1;i<entries;i++) {
+			power = ctx.mont_mul(power, x);
+			scatter(power, i);
+		}
+
+		// the exponent is scanned over whole limbs, at least as many as the modulus has
+		const uint64_t *e = exp.__get_op();
+		const size_t bits = 64*std::max(k, (limb::bit_length(e, op_size)+63)/64);
+		auto window = [&](size_t low, size_t width) -> size_t {
+			size_t value = 0;
+			for(size_t j=low+width;j --> low;) value = (value << 1) | ((e[op_size-1-j/64] >> (j%64)) & 1);
+			return value;
+		};
+
+		// the top window takes whatever is left over so that the other windows are all w bits wide
+		size_t low = bits - (bits%w == 0 ? w : bits%w);
+		uint_type acc, entry;
+		gather(acc, window(low, bits-low));
+		while(low > 0) {
+			low -= w;
+			for(unsigned j=0;j<w;j++) acc = ctx.mont_sqr(acc);
+			gather(entry, window(low, w));
+			acc = ctx.mont_mul(acc, entry);
+		}
+		return ctx.from_mont(acc);
+	}
+
+	template<typename uint_type>
+	uint_type powmod_ct(const uint_type &base, const uint_type &exp, const uint_type &mod)
+	{
+		return powmod_ct(base, exp, MontgomeryContext<uint_type>(mod));
+	}
+}; /* NAMESPACE BIGINT */
+
+#endif /* MODULAR_CPP */
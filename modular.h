@@ -0,0 +1,177 @@
+#ifndef MODULAR_H
+#define MODULAR_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <array>
+
+#include "bigint.h"
+
+// Modular arithmetic for the BigUint types: reduction contexts for a fixed modulus and modular exponentiation.
+// Every context has the same interface (to_domain, from_domain, mul, sqr, one) so that powmod can use either one
+
+namespace BigInt
+{
+	// raise when a modulus can't be used by a reduction context
+	class modulus_error : public std::runtime_error {
+		public: explicit modulus_error(const char *str) : std::runtime_error(str) {}
+	};
+
+	// raise when a value has no inverse modulo the modulus
+	class not_invertible_error : public std::runtime_error {
+		public: explicit not_invertible_error(const char *str) : std::runtime_error(str) {}
+	};
+
+	// Montgomery multiplication for a fixed odd modulus n. R = 2^(64k) where k is the number of significant limbs of n,
+	// so a small modulus in a wide type only pays for the limbs it uses. Values in Montgomery form are a*R mod n
+	template<typename uint_type>
+	class MontgomeryContext
+	{
+		protected:
+			const constexpr static size_t op_size = uint_type::__get_op_size();
+
+			uint_type n;
+			uint_type r2; // R^2 mod n, for converting to Montgomery form
+			uint_type one_mont; // R mod n, 1 in Montgomery form
+			uint64_t n0inv; // -n^-1 mod 2^64
+			size_t k; // significant limbs of n
+
+			// pointer to the low k limbs
+			inline const uint64_t *low(const uint_type &a) const { return a.__get_op()+op_size-k; }
+
+		public:
+			explicit MontgomeryContext(const uint_type &mod);
+
+			// a*R mod n
+			uint_type to_mont(const uint_type &a) const;
+
+			// a*R^-1 mod n, converts out of Montgomery form
+			uint_type from_mont(const uint_type &a) const;
+
+			// a*b*R^-1 mod n, a and b have to be in Montgomery form
+			uint_type mont_mul(const uint_type &a, const uint_type &b) const;
+
+			// a*a*R^-1 mod n with the squaring kernel, every cross product is computed once. Constant time like mont_mul
+			uint_type mont_sqr(const uint_type &a) const;
+
+			// a mod n for any a without a division, the limbs of a are folded in k limb pieces from the top with two
+			// Montgomery multiplications each. Constant time like mont_mul, for a secret modulus or a secret a
+			uint_type reduce(const uint_type &a) const;
+
+			// (a+b) mod n and (a-b) mod n for a, b less than n, the correction by n is selected with a mask
+			uint_type mod_add(const uint_type &a, const uint_type &b) const;
+			uint_type mod_sub(const uint_type &a, const uint_type &b) const;
+
+			inline const uint_type &modulus() const { return n; }
+			inline const uint_type &mont_one() const { return one_mont; }
+			inline size_t limbs() const { return k; }
+
+			// reduction context interface
+			inline uint_type to_domain(const uint_type &a) const { return to_mont(a); }
+			inline uint_type from_domain(const uint_type &a) const { return from_mont(a); }
+			inline uint_type mul(const uint_type &a, const uint_type &b) const { return mont_mul(a, b); }
+			inline uint_type sqr(const uint_type &a) const { return mont_sqr(a); }
+			inline const uint_type &one() const { return one_mont; }
+	};
+
+	// Barrett reduction for a fixed modulus n of k significant limbs, mu = floor(2^(128k)/n).
+	// Works for any non-zero modulus and needs no conversion, a double-width value is reduced with two multiplications and no division
+	template<typename uint_type>
+	class BarrettContext
+	{
+		protected:
+			const constexpr static size_t op_size = uint_type::__get_op_size();
+
+			uint_type n;
+			std::array<uint64_t, op_size+1> mu; // k+1 limbs at the end
+			std::array<uint64_t, op_size+1> n_ext; // n with k+1 limbs at the end
+			uint_type one_mod; // 1 mod n
+			size_t k; // significant limbs of n
+
+		public:
+			explicit BarrettContext(const uint_type &mod);
+
+			// x[xn] mod n where x < 2^(128k), e.g. a full product of two values less than n
+			uint_type reduce(const uint64_t *x, size_t xn) const;
+
+			// a mod n for any a
+			uint_type reduce(const uint_type &a) const;
+
+			// a*b mod n, a and b have to be less than n
+			uint_type mul(const uint_type &a, const uint_type &b) const;
+
+			// a*a mod n
+			uint_type sqr(const uint_type &a) const;
+
+			inline const uint_type &modulus() const { return n; }
+
+			// reduction context interface, Barrett values are ordinary residues
+			inline uint_type to_domain(const uint_type &a) const { return reduce(a); }
+			inline uint_type from_domain(const uint_type &a) const { return a; }
+			inline const uint_type &one() const { return one_mod; }
+	};
+
+	// a*b mod mod with a full product and one long division, for a single multiplication where a context doesn't pay off
+	template<typename uint_type>
+	uint_type mulmod(const uint_type &a, const uint_type &b, const uint_type &mod);
+
+	// gcd(a, b) and Bezout cofactors with a*x - b*y = gcd, both non-negative and x <= b/gcd. For a = 0 there are none, x and y are 0
+	template<typename uint_type>
+	struct ext_gcd_result
+	{
+		uint_type gcd;
+		uint_type x;
+		uint_type y;
+	};
+
+	// greatest common divisor with Lehmer's algorithm: the top 63 bits of both numbers run Euclid's algorithm in single
+	// words and the collected quotients are applied to the full numbers at once, about 30 bits per pass. gcd(0, 0) is 0
+	template<typename uint_type>
+	uint_type gcd(const uint_type &a, const uint_type &b);
+
+	// least common multiple a/gcd(a, b)*b, truncated to the bitsize like operator*. 0 if either is 0
+	template<typename uint_type>
+	uint_type lcm(const uint_type &a, const uint_type &b);
+
+	// gcd and cofactors from the same Lehmer passes as gcd, the cofactors are updated with the same single word matrices
+	template<typename uint_type>
+	ext_gcd_result<uint_type> ext_gcd(const uint_type &a, const uint_type &b);
+
+	// x with a*x = 1 mod mod and x < mod. Throws not_invertible_error if gcd(a, mod) isn't 1 and division_by_zero_error for mod 0.
+	// Works for even moduli, e.g. the private exponent e^-1 mod phi(n)
+	template<typename uint_type>
+	uint_type mod_inverse(const uint_type &a, const uint_type &mod);
+
+	// sliding window width for an exponent of exp_bits bits, balances the odd-power table size against the multiplications saved
+	inline constexpr unsigned powmod_window_bits(size_t exp_bits);
+
+	// base^exp mod ctx.modulus() with any reduction context, pick the context that is faster for the modulus.
+	// Left-to-right sliding window exponentiation with a table of odd powers, the run time depends on exp.
+	// Only for public exponents and moduli, e.g. RSA encryption and the fault check; private key code uses powmod_ct
+	template<typename uint_type, typename context_type>
+	uint_type powmod(const uint_type &base, const uint_type &exp, const context_type &ctx);
+
+	// base^exp mod mod. Odd moduli use a MontgomeryContext and even moduli a BarrettContext. Variable time like above
+	template<typename uint_type>
+	uint_type powmod(const uint_type &base, const uint_type &exp, const uint_type &mod);
+
+	// fixed window width of powmod_ct for a modulus of mod_bits bits
+	inline constexpr unsigned powmod_ct_window_bits(size_t mod_bits);
+
+	// base^exp mod ctx.modulus() for secret exponents. Fixed windows that always square and multiply, and every table entry is
+	// read for every window, so neither the run time nor the memory access pattern depends on exp (only its limb count is visible).
+	// Every operation with a private key (RSA decryption and signing, the CRT and multi-prime exponents) has to use this
+	// instead of powmod. A base of more limbs than the modulus is reduced by a division, which isn't constant time, so
+	// reduce it with ctx.reduce first if the modulus is secret as well
+	template<typename uint_type>
+	uint_type powmod_ct(const uint_type &base, const uint_type &exp, const MontgomeryContext<uint_type> &ctx);
+
+	// constant time base^exp mod mod, mod has to be odd
+	template<typename uint_type>
+	uint_type powmod_ct(const uint_type &base, const uint_type &exp, const uint_type &mod);
+}; /* NAMESPACE BIGINT */
+
+// include here because of template class and function
+#include "modular.cpp"
+
+#endif /* MODULAR_H */
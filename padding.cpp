@@ -0,0 +1,141 @@
+#ifndef PADDING_CPP
+#define PADDING_CPP
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <vector>
+#include <array>
+#include <random>
+#include <algorithm>
+
+#include "padding.h"
+
+namespace Padding
+{
+	inline constexpr size_t max_message_size(scheme s, size_t k)
+	{
+		// 11 bytes of v1.5 framing, two digests and two bytes for OAEP
+		const size_t overhead = s == scheme::oaep ? 2*Hash::Sha256::digest_size+2 : 11;
+		return k > overhead ? k-overhead : 0;
+	}
+
+	inline void random_bytes(std::span<std::byte> out)
+	{
+		std::random_device rd;
+		for(size_t i=0;i<out.size();i+=4) {
+			const uint32_t r = rd();
+			for(size_t j=0;j<4 && i+j<out.size();j++)
+				out[i+j] = std::byte(r >> 8*j);
+		}
+	}
+
+	inline void mgf1_xor(std::span<std::byte> out, std::span<const std::byte> seed)
+	{
+		constexpr const size_t h_len = Hash::Sha256::digest_size;
+		for(uint32_t counter=0;size_t(counter)*h_len<out.size();counter++) {
+			const std::array<std::byte, 4> c = {std::byte(counter >> 24), std::byte(counter >> 16), std::byte(counter >> 8), std::byte(counter)};
+			Hash::Sha256 hash;
+			hash.update(seed);
+			hash.update(c);
+			const Hash::Sha256::digest_type t = hash.finish();
+			const size_t offset = size_t(counter)*h_len, n = std::min(h_len, out.size()-offset);
+			for(size_t i=0;i<n;i++)
+				out[offset+i] ^= t[i];
+		}
+	}
+
+	inline void pkcs1_v15_pad(std::span<std::byte> em, std::span<const std::byte> message)
+	{
+		const size_t k = em.size();
+		if(message.size() > max_message_size(scheme::pkcs1_v15, k))
+			throw padding_error("message too long for the block");
+		const size_t ps_size = k-message.size()-3;
+		em[0] = std::byte(0);
+		em[1] = std::byte(2);
+		std::span<std::byte> ps = em.subspan(2, ps_size);
+		random_bytes(ps);
+		for(std::byte &b : ps)
+			while(b == std::byte(0)) random_bytes(std::span<std::byte>(&b, 1));
+		em[2+ps_size] = std::byte(0);
+		std::copy(message.begin(), message.end(), em.begin()+3+ps_size);
+	}
+
+	inline std::vector<std::byte> pkcs1_v15_unpad(std::span<const std::byte> em)
+	{
+		const size_t k = em.size();
+		if(k < 11) throw padding_error("decryption error");
+
+		// every byte is looked at, the position of the separator doesn't change which branches run
+		size_t good = size_t(em[0] == std::byte(0)) & size_t(em[1] == std::byte(2));
+		size_t separator = 0, found = 0;
+		for(size_t i=2;i<k;i++) {
+			const size_t zero = size_t(em[i] == std::byte(0));
+			separator |= i & (0-(zero & ~found & 1));
+			found |= zero;
+		}
+		good &= found & size_t(separator >= 10); // at least 8 padding bytes
+		if(!good) throw padding_error("decryption error");
+		return std::vector<std::byte>(em.begin()+separator+1, em.end());
+	}
+
+	inline void oaep_pad(std::span<std::byte> em, std::span<const std::byte> message, std::span<const std::byte> label)
+	{
+		constexpr const size_t h_len = Hash::Sha256::digest_size;
+		const size_t k = em.size();
+		if(message.size() > max_message_size(scheme::oaep, k))
+			throw padding_error("message too long for the block");
+
+		std::span<std::byte> seed = em.subspan(1, h_len), db = em.subspan(1+h_len);
+		em[0] = std::byte(0);
+		const Hash::Sha256::digest_type l_hash = Hash::sha256(label);
+		std::copy(l_hash.begin(), l_hash.end(), db.begin());
+		std::fill(db.begin()+h_len, db.end()-message.size()-1, std::byte(0));
+		db[db.size()-message.size()-1] = std::byte(1);
+		std::copy(message.begin(), message.end(), db.end()-message.size());
+
+		random_bytes(seed);
+		mgf1_xor(db, seed);
+		mgf1_xor(seed, db);
+	}
+
+	inline std::vector<std::byte> oaep_unpad(std::span<const std::byte> em, std::span<const std::byte> label)
+	{
+		constexpr const size_t h_len = Hash::Sha256::digest_size;
+		const size_t k = em.size();
+		if(k < 2*h_len+2) throw padding_error("decryption error");
+
+		std::vector<std::byte> buffer(em.begin()+1, em.end());
+		std::span<std::byte> seed = std::span<std::byte>(buffer).subspan(0, h_len), db = std::span<std::byte>(buffer).subspan(h_len);
+		mgf1_xor(seed, db);
+		mgf1_xor(db, seed);
+
+		// leading byte, label hash and the 0x01 after the zeros are all checked before anything is decided
+		const Hash::Sha256::digest_type l_hash = Hash::sha256(label);
+		uint8_t diff = uint8_t(em[0]);
+		for(size_t i=0;i<h_len;i++)
+			diff |= uint8_t(db[i] ^ l_hash[i]);
+		size_t separator = 0, found = 0, invalid = 0;
+		for(size_t i=h_len;i<db.size();i++) {
+			const size_t one = size_t(db[i] == std::byte(1)), zero = size_t(db[i] == std::byte(0));
+			separator |= i & (0-(one & ~found & 1));
+			invalid |= ~found & ~one & ~zero & 1; // a byte other than 0 or 1 before the separator
+			found |= one;
+		}
+		if(diff != 0 || !found || invalid) throw padding_error("decryption error");
+		return std::vector<std::byte>(db.begin()+separator+1, db.end());
+	}
+
+	inline void pad(scheme s, std::span<std::byte> em, std::span<const std::byte> message)
+	{
+		if(s == scheme::oaep) oaep_pad(em, message);
+		else pkcs1_v15_pad(em, message);
+	}
+
+	inline std::vector<std::byte> unpad(scheme s, std::span<const std::byte> em)
+	{
+		return s == scheme::oaep ? oaep_unpad(em) : pkcs1_v15_unpad(em);
+	}
+}; /* NAMESPACE PADDING */
+
+#endif /* PADDING_CPP */
@@ -0,0 +1,54 @@
+#ifndef PADDING_H
+#define PADDING_H
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <vector>
+#include <stdexcept>
+
+#include "sha256.h"
+
+// RSA encryption padding of PKCS #1 (RFC 8017): the v1.5 scheme and OAEP with SHA-256 and MGF1. A message is turned into
+// an encoded block em of k bytes, the length of n, whose big-endian value is less than n and is what gets exponentiated
+
+namespace Padding
+{
+	// raise when a decrypted block isn't a valid encoding. The reason is never told apart, a decryption oracle that
+	// does would let an attacker decrypt (Bleichenbacher, Manger)
+	class padding_error : public std::runtime_error {
+		public: explicit padding_error(const char *str) : std::runtime_error(str) {}
+	};
+
+	enum class scheme : uint8_t { pkcs1_v15 = 1, oaep = 2 };
+
+	// longest message one block of k bytes holds, 0 if k is too short for the scheme at all
+	inline constexpr size_t max_message_size(scheme s, size_t k);
+
+	// fills out with bytes from std::random_device
+	inline void random_bytes(std::span<std::byte> out);
+
+	// out ^= MGF1-SHA256(seed) over the length of out
+	inline void mgf1_xor(std::span<std::byte> out, std::span<const std::byte> seed);
+
+	// EM = 0x00 || 0x02 || at least 8 random non-zero bytes || 0x00 || message
+	inline void pkcs1_v15_pad(std::span<std::byte> em, std::span<const std::byte> message);
+
+	// message of a v1.5 block, padding_error if em isn't one
+	inline std::vector<std::byte> pkcs1_v15_unpad(std::span<const std::byte> em);
+
+	// EM = 0x00 || maskedSeed || maskedDB with DB = SHA256(label) || zeros || 0x01 || message
+	inline void oaep_pad(std::span<std::byte> em, std::span<const std::byte> message, std::span<const std::byte> label = {});
+
+	// message of an OAEP block, padding_error if em isn't one for this label
+	inline std::vector<std::byte> oaep_unpad(std::span<const std::byte> em, std::span<const std::byte> label = {});
+
+	// pad or unpad with the scheme
+	inline void pad(scheme s, std::span<std::byte> em, std::span<const std::byte> message);
+	inline std::vector<std::byte> unpad(scheme s, std::span<const std::byte> em);
+}; /* NAMESPACE PADDING */
+
+// include here because of the single translation unit build
+#include "padding.cpp"
+
+#endif /* PADDING_H */
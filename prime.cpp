@@ -0,0 +1,227 @@
+#ifndef PRIME_CPP
+#define PRIME_CPP
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <random>
+#include <algorithm>
+#include <bit>
+#include <utility>
+#include <optional>
+#include <mutex>
+#include <thread>
+#include <stop_token>
+#include <vector>
+
+#include "prime.h"
+
+namespace BigInt
+{
+	namespace prime
+	{
+		inline constexpr void residues(uint16_t *residues, const uint64_t *a, size_t n, size_t count)
+		{
+			for(const prime_group &g : groups) {
+				if(g.first >= count) break;
+				const uint64_t r = limb::divrem_1(nullptr, a, n, g.product);
+				for(size_t i=g.first;i<g.last;i++) residues[i] = uint16_t(r%small_primes[i]);
+			}
+		}
+
+		inline constexpr size_t miller_rabin_rounds(size_t bits)
+		{
+			if(bits >= 1536) return 4;
+			if(bits >= 1024) return 5;
+			if(bits >= 512) return 7;
+			return worst_case_rounds;
+		}
+
+		// a^d mod n, then up to s-1 squarings looking for n-1. false means a witnesses that n is composite
+		template<typename uint_type>
+		bool miller_rabin_round(const uint_type &a, const uint_type &d, size_t s, const MontgomeryContext<uint_type> &ctx,
+		                        const uint_type &minus_one)
+		{
+			uint_type x = ctx.to_mont(powmod(a, d, ctx));
+			if(x == ctx.mont_one() || x == minus_one) return true;
+			for(size_t i=1;i<s;i++) {
+				x = ctx.mont_sqr(x);
+				if(x == minus_one) return true;
+				if(x == ctx.mont_one()) return false; // a non-trivial square root of 1
+			}
+			return false;
+		}
+
+		template<typename uint_type>
+		bool miller_rabin(const uint_type &n, size_t rounds)
+		{
+			constexpr const size_t op_size = uint_type::__get_op_size();
+			const uint64_t *n_op = n.__get_op();
+			const size_t bits = limb::bit_length(n_op, op_size), k = (bits+63)/64;
+
+			// n-1 = d*2^s with d odd, n-1 is n with the low bit cleared
+			size_t s = 0;
+			for(size_t i=op_size;i --> 0;s+=64) {
+				const uint64_t limb = i == op_size-1 ? n_op[i] & ~uint64_t(1) : n_op[i];
+				if(limb != 0) {
+					s += std::countr_zero(limb);
+					break;
+				}
+			}
+			uint_type minus_one_plain = n;
+			minus_one_plain -= uint_type(1);
+			const uint_type d = minus_one_plain >> uint16_t(s);
+
+			const MontgomeryContext<uint_type> ctx(n);
+			const uint_type minus_one = ctx.to_mont(minus_one_plain);
+
+			// the first 12 primes as bases decide every n below 2^64 (and up to 3.3*10^24)
+			if(k == 1) {
+				for(uint64_t a : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}) {
+					if(a < n_op[op_size-1] && !miller_rabin_round(uint_type(a), d, s, ctx, minus_one)) return false;
+				}
+				return true;
+			}
+
+			// random bases in [2, n-2]
+			uint_type range = n;
+			range -= uint_type(4);
+			for(size_t i=0;i<rounds;i++) {
+				const uint_type a = uint_type::random(range) + uint_type(2);
+				if(!miller_rabin_round(a, d, s, ctx, minus_one)) return false;
+			}
+			return true;
+		}
+
+		template<typename uint_type>
+		sieve<uint_type>::sieve(const uint_type &start, uint64_t step) : start(start), step(step)
+		{
+			constexpr const size_t op_size = uint_type::__get_op_size();
+			const uint64_t *op = start.__get_op();
+			const size_t k = (limb::bit_length(op, op_size)+63)/64;
+			prime::residues(residues.data(), op+op_size-k, k);
+			for(size_t i=0;i<steps.size();i++)
+				steps[i] = uint16_t(step % small_primes[i]);
+		}
+
+		template<typename uint_type>
+		uint_type sieve<uint_type>::next()
+		{
+			// every residue moves by step per candidate, wrapping with a compare instead of a division
+			while(true) {
+				delta += step;
+				bool survivor = true;
+				for(size_t i=0;i<residues.size();i++) {
+					uint16_t r = residues[i]+steps[i];
+					if(r >= small_primes[i]) r -= small_primes[i];
+					residues[i] = r;
+					survivor &= r != 0;
+				}
+				if(survivor) return candidate();
+			}
+		}
+
+		template<typename uint_type>
+		bool sieve<uint_type>::empty() const
+		{
+			for(size_t i=0;i<residues.size();i++)
+				if(steps[i] == 0 && residues[i] == 0) return true;
+			return false;
+		}
+
+		template<typename uint_type>
+		uint_type sieve<uint_type>::candidate() const
+		{
+			uint_type ret = start;
+			return ret + uint_type(delta);
+		}
+	}; /* NAMESPACE PRIME */
+
+	template<typename uint_type>
+	bool is_probable_prime(const uint_type &n, size_t rounds)
+	{
+		constexpr const size_t op_size = uint_type::__get_op_size();
+		const uint64_t *n_op = n.__get_op();
+		const size_t bits = limb::bit_length(n_op, op_size), k = (bits+63)/64;
+		if(bits <= 1) return false;
+		if((n_op[op_size-1] & 1) == 0) return bits == 2; // 2 is the only even prime
+
+		// small primes are in the table, anything else with a small factor is composite
+		constexpr const uint64_t limit = prime::trial_division_limit;
+		if(k == 1 && n_op[op_size-1] < limit)
+			return std::binary_search(prime::small_primes.begin(), prime::small_primes.begin()+prime::trial_division_count, uint16_t(n_op[op_size-1]));
+		std::array<uint16_t, prime::trial_division_count> r;
+		prime::residues(r.data(), n_op+op_size-k, k, r.size());
+		if(std::find(r.begin(), r.end(), uint16_t(0)) != r.end()) return false;
+		if(k == 1 && n_op[op_size-1] < limit*limit) return true;
+
+		return prime::miller_rabin(n, rounds == 0 ? prime::miller_rabin_rounds(bits) : rounds);
+	}
+
+	namespace prime
+	{
+		// one worker of generate_prime: candidates start+2*worker, start+2*(worker+workers), ... until a prime turns up,
+		// the start is used up or another worker found one. The first prime goes to found and stops every worker
+		template<typename uint_type>
+		void search(const uint_type &start, size_t worker, size_t workers, size_t bits, size_t rounds,
+			std::stop_source &stop, std::optional<uint_type> &found, std::mutex &found_mutex)
+		{
+			constexpr const uint64_t max_sieve_offset = uint64_t(1) << 24;
+			uint_type first = start;
+			sieve<uint_type> candidates(first + uint_type(2*worker), 2*workers);
+			const std::stop_token token = stop.get_token();
+			if(candidates.empty()) return; // the other workers cover these with a factor anyway
+
+			// primes are about bits*ln(2) apart, a start that runs past 2^bits or far beyond the usual gap is dropped
+			while(!token.stop_requested() && candidates.offset() < max_sieve_offset) {
+				const uint_type candidate = candidates.next();
+				if(limb::bit_length(candidate.__get_op(), uint_type::__get_op_size()) > bits) break;
+				if(miller_rabin(candidate, rounds)) {
+					std::lock_guard<std::mutex> lock(found_mutex);
+					if(!found) found = candidate;
+					stop.request_stop();
+					break;
+				}
+			}
+		}
+	}; /* NAMESPACE PRIME */
+
+	template<typename uint_type>
+	uint_type generate_prime(size_t bits, size_t threads)
+	{
+		if(bits < 16 || bits > 64*uint_type::__get_op_size())
+			throw prime_size_error("generate_prime bit size has to be between 16 and the bitsize of the type");
+		threads = std::max<size_t>(threads, 1);
+
+		// random odd start with the top two bits set: top | random below 2^(bits-2) | 1
+		const uint_type one = 1;
+		uint_type low_mask = uint_type(1) << uint16_t(bits-2), top = uint_type(3) << uint16_t(bits-2);
+		low_mask -= one;
+		const size_t rounds = prime::miller_rabin_rounds(bits);
+		while(true) {
+			const uint_type start = uint_type::random(low_mask) | top | one;
+			std::stop_source stop;
+			std::optional<uint_type> found;
+			std::mutex found_mutex;
+			if(threads == 1) {
+				prime::search(start, 0, 1, bits, rounds, stop, found, found_mutex);
+			} else {
+				// jthreads join when workers goes out of scope
+				std::vector<std::jthread> workers;
+				workers.reserve(threads);
+				for(size_t i=0;i<threads;i++)
+					workers.emplace_back([&, i] { prime::search(start, i, threads, bits, rounds, stop, found, found_mutex); });
+			}
+			if(found) return *found;
+		}
+	}
+
+	template<size_t bits, typename uint_type>
+	uint_type generate_prime(size_t threads)
+	{
+		static_assert(bits >= 16 && bits <= 64*uint_type::__get_op_size(), "generate_prime bit size has to be between 16 and the bitsize of the type");
+		return generate_prime<uint_type>(bits, threads);
+	}
+}; /* NAMESPACE BIGINT */
+
+#endif /* PRIME_CPP */
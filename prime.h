@@ -0,0 +1,155 @@
+#ifndef PRIME_H
+#define PRIME_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <stdexcept>
+
+#include "bigint.h"
+#include "modular.h"
+
+// Probabilistic primality testing and random prime generation. Candidates are trial divided by the odd primes below
+// trial_division_limit first, one division pass per group of primes whose product fits a limb, then Miller-Rabin runs
+// on the Montgomery powmod. The generator sieves by every prime of the table with residues it updates per step
+
+namespace BigInt
+{
+	// raise when a prime of the requested size can't be generated
+	class prime_size_error : public std::runtime_error {
+		public: explicit prime_size_error(const char *str) : std::runtime_error(str) {}
+	};
+
+	namespace prime
+	{
+		constexpr const uint16_t small_prime_limit = 32768; // 3511 odd primes for the generator's sieve
+		constexpr const uint16_t trial_division_limit = 1024; // is_probable_prime divides by the first 171 of them
+
+		// number of odd primes below limit
+		inline constexpr size_t count_odd_primes(uint16_t limit)
+		{
+			size_t count = 0;
+			for(uint16_t p=3;p<limit;p+=2) {
+				bool composite = false;
+				for(uint16_t d=3;d*d<=p && !composite;d+=2) composite = p%d == 0;
+				count += !composite;
+			}
+			return count;
+		}
+
+		constexpr const size_t trial_division_count = count_odd_primes(trial_division_limit);
+
+		// the odd primes below small_prime_limit, ascending
+		inline constexpr const std::array<uint16_t, count_odd_primes(small_prime_limit)> small_primes = []() {
+			std::array<uint16_t, count_odd_primes(small_prime_limit)> table{};
+			size_t count = 0;
+			for(uint16_t p=3;p<small_prime_limit;p+=2) {
+				bool composite = false;
+				for(uint16_t d=3;d*d<=p && !composite;d+=2) composite = p%d == 0;
+				if(!composite) table[count++] = p;
+			}
+			return table;
+		}();
+
+		// consecutive small primes [first, last) with their product, which is below 2^64
+		struct prime_group
+		{
+			uint64_t product;
+			uint16_t first;
+			uint16_t last;
+		};
+
+		// number of groups when small_primes is cut greedily into products that fit a limb
+		inline constexpr size_t count_groups()
+		{
+			size_t count = 0;
+			for(size_t i=0;i<small_primes.size();count++) {
+				const size_t first = i;
+				for(uint64_t product=1;i < small_primes.size() && (__uint128_t)product*small_primes[i] <= UINT64_MAX;) {
+					if(i == trial_division_count && i != first) break;
+					product *= small_primes[i++];
+				}
+			}
+			return count;
+		}
+
+		inline constexpr const std::array<prime_group, count_groups()> groups = []() {
+			std::array<prime_group, count_groups()> table{};
+			size_t count = 0;
+			for(size_t i=0;i<small_primes.size();) {
+				prime_group g = {1, uint16_t(i), uint16_t(i)};
+				while(i < small_primes.size() && (__uint128_t)g.product*small_primes[i] <= UINT64_MAX) {
+					if(i == trial_division_count && i != g.first) break; // the trial division primes end on a group boundary
+					g.product *= small_primes[i++];
+				}
+				g.last = uint16_t(i);
+				table[count++] = g;
+			}
+			return table;
+		}();
+
+		// residues[i] = a[n] mod small_primes[i] for the first count primes, one divrem_1 pass over a per group
+		inline constexpr void residues(uint16_t *residues, const uint64_t *a, size_t n, size_t count = small_primes.size());
+
+		// Miller-Rabin rounds for any odd composite, chosen by an adversary or not: 4^-50 = 2^-100
+		constexpr const size_t worst_case_rounds = 50;
+
+		// Miller-Rabin rounds for a random candidate of bits bits, FIPS 186-5 table B.1 for RSA primes
+		// (error probability below 2^-100 for the sizes it covers) and 4^-rounds worst case bounds below that.
+		// The table only holds for numbers drawn at random, not for ones handed in from outside
+		inline constexpr size_t miller_rabin_rounds(size_t bits);
+
+		// Miller-Rabin alone for an odd n > 3 without small factors, rounds random bases (fixed bases below 2^64)
+		template<typename uint_type>
+		bool miller_rabin(const uint_type &n, size_t rounds);
+
+		// odd candidates start, start+step, start+2*step, ... with a residue of start+delta for every small prime, moving
+		// to the next candidate adds step to each residue and never divides the big number again. Workers of a parallel
+		// search share a start and interleave with start+2*i and step 2*workers
+		template<typename uint_type>
+		class sieve
+		{
+			protected:
+				uint_type start;
+				uint64_t delta = 0, step;
+				std::array<uint16_t, small_primes.size()> residues; // of start+delta
+				std::array<uint16_t, small_primes.size()> steps; // step mod every small prime
+
+			public:
+				// start has to be odd and step even
+				explicit sieve(const uint_type &start, uint64_t step = 2);
+
+				// moves past the current candidate to the next one without a factor below small_prime_limit, returns start+delta
+				uint_type next();
+
+				// start+delta
+				uint_type candidate() const;
+
+				inline uint64_t offset() const { return delta; }
+
+				// a small prime dividing both step and start divides every candidate, next() would never return
+				bool empty() const;
+		};
+	}; /* NAMESPACE PRIME */
+
+	// false if n is composite, true if n is prime with an error probability of at most 4^-rounds. The default holds for
+	// any input, e.g. primes a user typed in. 0 picks prime::miller_rabin_rounds by the bit size, only for random
+	// candidates. Numbers below 2^64 use fixed bases and are always answered exactly
+	template<typename uint_type>
+	bool is_probable_prime(const uint_type &n, size_t rounds = prime::worst_case_rounds);
+
+	// random prime of exactly bits bits with the top two bits set, so the product of two has exactly 2*bits bits.
+	// BigUint::random picks an odd start, the sieve steps to candidates without small factors and only those run
+	// Miller-Rabin. bits has to be at least 16 and fit uint_type, otherwise prime_size_error is thrown.
+	// threads > 1 splits the candidates of one start across that many workers, the first prime found stops the others
+	template<typename uint_type>
+	uint_type generate_prime(size_t bits, size_t threads = 1);
+
+	template<size_t bits, typename uint_type = BigUint<bits>>
+	uint_type generate_prime(size_t threads = 1);
+}; /* NAMESPACE BIGINT */
+
+// include here because of template function
+#include "prime.cpp"
+
+#endif /* PRIME_H */
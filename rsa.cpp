@@ -7,131 +7,387 @@
 #include <sstream>
 #include <math.h>
 #include <iomanip>
+#include <span>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <string_view>
 
 #include "bigint.h"
+#include "modular.h"
+#include "prime.h"
+#include "rsa.h"
+#include "batch.h"
 
-// Rivest Shamir & Adleman
+// self checks of ./rsa check (make check), every failure is printed and counted
+size_t check_failures = 0;
+
+void check(bool ok, const std::string &what)
+{
+	if(!ok) {
+		check_failures++;
+		std::cout << "FAILED:\t" << what << std::endl;
+	}
+}
+
+template<typename error_type, typename function_type>
+bool throws(function_type f)
+{
+	try {
+		f();
+	} catch(const error_type &) {
+		return true;
+	}
+	return false;
+}
+
+// encrypt_message and decrypt_message with both padding schemes: an empty message, one full block and a message over
+// three blocks come back unchanged, a tampered block and a block that isn't less than n are rejected
+template<typename uint_type, typename key_type>
+void check_message(Rsa<uint_type> &rsa, const key_type &key, const std::string &name)
+{
+	for(Padding::scheme s : {Padding::scheme::pkcs1_v15, Padding::scheme::oaep}) {
+		const std::string what = name + (s == Padding::scheme::oaep ? " OAEP" : " PKCS #1 v1.5");
+		const size_t header = rsa.message_header_size, k = rsa.block_size(key.n), chunk = Padding::max_message_size(s, k);
+
+		for(size_t size : {size_t(0), chunk, 2*chunk+chunk/2}) {
+			std::vector<std::byte> message(size);
+			Padding::random_bytes(message);
+			const std::vector<std::byte> ciphertext = rsa.encrypt_message(message, key.n, key.pub_key, s);
+			check(ciphertext.size() == header+std::max<size_t>((size+chunk-1)/chunk, 1)*k, what + " block count");
+			check(rsa.decrypt_message(ciphertext, key) == message, what + " round trip of " + std::to_string(size) + " bytes");
+		}
+
+		std::vector<std::byte> message(2*chunk);
+		Padding::random_bytes(message);
+		const std::vector<std::byte> ciphertext = rsa.encrypt_message(message, key.n, key.pub_key, s);
+
+		// a v1.5 block of random bytes has valid padding about once in 2^16, an OAEP block practically never
+		std::vector<std::byte> tampered = ciphertext;
+		tampered[header+k+k/2] ^= std::byte(1);
+		bool changed = true;
+		const bool rejected = throws<Padding::padding_error>([&] { changed = rsa.decrypt_message(tampered, key) != message; });
+		check(rejected || (s == Padding::scheme::pkcs1_v15 && changed), what + " tampered block");
+
+		std::vector<std::byte> out_of_range = ciphertext;
+		key.n.to_bytes(std::span<std::byte>(out_of_range).subspan(header+k, k));
+		check(throws<Padding::padding_error>([&] { rsa.decrypt_message(out_of_range, key); }), what + " block not less than n");
+
+		std::vector<std::byte> bad_header = ciphertext;
+		bad_header[3] = std::byte(2);
+		check(throws<ciphertext_format_error>([&] { rsa.decrypt_message(bad_header, key); }), what + " header version");
+	}
+}
+
+// hybrid_encrypt and hybrid_decrypt, the session key goes through the private key operation of every key type
+template<typename uint_type, typename key_type>
+void check_hybrid(Rsa<uint_type> &rsa, const key_type &key, const std::string &name)
+{
+	std::vector<std::byte> message(2500);
+	Padding::random_bytes(message);
+	std::vector<std::byte> ciphertext = rsa.hybrid_encrypt(message, key.n, key.pub_key, 1000);
+	check(rsa.hybrid_decrypt(ciphertext, key) == message, name + " hybrid round trip");
+	std::vector<std::byte> large_chunks = ciphertext;
+	std::fill(large_chunks.begin()+8, large_chunks.begin()+12, std::byte(0xff)); // the chunk size field
+	check(throws<ciphertext_format_error>([&] { rsa.hybrid_decrypt(large_chunks, key); }), name + " hybrid chunk size too large");
+	ciphertext[rsa.hybrid_header_size] ^= std::byte(1); // the KEM block
+	check(throws<std::runtime_error>([&] { rsa.hybrid_decrypt(ciphertext, key); }), name + " hybrid tampered KEM block");
+}
+
+std::vector<std::byte> from_hex(std::string_view hex)
+{
+	std::vector<std::byte> ret;
+	for(size_t i=0;i+1<hex.size();i+=2)
+		ret.push_back(std::byte(std::stoul(std::string(hex.substr(i, 2)), nullptr, 16)));
+	return ret;
+}
+
+std::vector<std::byte> from_text(std::string_view text)
+{
+	std::vector<std::byte> ret(text.size());
+	std::transform(text.begin(), text.end(), ret.begin(), [](char c) { return std::byte(c); });
+	return ret;
+}
+
+// the Poly1305 and AEAD test vectors of RFC 8439 (sections 2.5.2 and 2.8.2)
+void check_aead_vectors()
+{
+	const std::vector<std::byte> poly_key = from_hex("85d6be7857556d337f4452fe42d506a80103808afb0db2fd4abff6af4149f51b");
+	Aead::Poly1305 poly(std::span<const std::byte, 32>(poly_key.data(), 32));
+	poly.update(from_text("Cryptographic Forum Research Group"));
+	const Aead::tag_type poly_tag = poly.finish();
+	check(std::vector<std::byte>(poly_tag.begin(), poly_tag.end()) == from_hex("a8061dc1305136c6c22b8baf0c0127a9"), "Poly1305 vector");
+
+	Aead::key_type key;
+	for(size_t i=0;i<key.size();i++) key[i] = std::byte(0x80+i);
+	Aead::nonce_type nonce;
+	const std::vector<std::byte> nonce_bytes = from_hex("070000004041424344454647");
+	std::copy(nonce_bytes.begin(), nonce_bytes.end(), nonce.begin());
+	const std::vector<std::byte> aad = from_hex("50515253c0c1c2c3c4c5c6c7");
+	const std::vector<std::byte> plaintext = from_text("Ladies and Gentlemen of the class of '99: If I could offer you only one tip "
+		"for the future, sunscreen would be it.");
+	const std::vector<std::byte> expected = from_hex(
+		"d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d63dbea45e8ca9671282fafb69da92728b"
+		"1a71de0a9e060b2905d6a5b67ecd3b3692ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc"
+		"3ff4def08e4b7a9de576d26586cec64b6116");
+
+	std::vector<std::byte> data = plaintext;
+	const Aead::tag_type tag = Aead::seal(data, key, nonce, aad);
+	check(data == expected, "AEAD vector ciphertext");
+	check(std::vector<std::byte>(tag.begin(), tag.end()) == from_hex("1ae10b594f09e26a7e902ecbd0600691"), "AEAD vector tag");
+	Aead::open(data, tag, key, nonce, aad);
+	check(data == plaintext, "AEAD vector open");
+
+	data = expected;
+	data[7] ^= std::byte(1);
+	check(throws<Aead::authentication_error>([&] { Aead::open(data, tag, key, nonce, aad); }), "AEAD tampered ciphertext");
+	check(data[7] == (expected[7] ^ std::byte(1)), "AEAD tampered ciphertext stays encrypted");
+}
+
+// 1024 bytes of the ChaCha20 key stream of RFC 8439 section 2.4.2 (key 00..1f, counter 1), through every kernel that
+// is available: the dispatching chacha20_xor, the scalar blocks, the 4 lane SSE2 and the 8 lane AVX2 kernel
+void check_keystream()
+{
+	Aead::key_type key;
+	for(size_t i=0;i<key.size();i++) key[i] = std::byte(i);
+	Aead::nonce_type nonce{};
+	nonce[7] = std::byte(0x4a);
+	const std::array<uint32_t, 16> state = Aead::chacha::initial_state(key, 1, nonce);
+	const std::vector<std::byte> first = from_hex("224f51f3401bd9e12fde276fb8631ded");
+	const std::vector<std::byte> digest = from_hex("28ba0d2d2ab48bba84bdbb842e416fc6cdf4d76854e14f8e80afb12ebd051866");
+
+	auto check_stream = [&](const std::vector<std::byte> &stream, const std::string &kernel) {
+		const Hash::Sha256::digest_type d = Hash::sha256(stream);
+		check(std::equal(first.begin(), first.end(), stream.begin()) && std::vector<std::byte>(d.begin(), d.end()) == digest,
+			"ChaCha20 key stream " + kernel);
+	};
+	// one call of kernel per lanes blocks, the counter moves by the lanes
+	auto run_kernel = [&](auto kernel, size_t lanes) {
+		std::vector<std::byte> stream(1024);
+		std::array<uint32_t, 16> s = state;
+		for(size_t i=0;i<stream.size();i+=64*lanes,s[12]+=lanes)
+			kernel(stream.data()+i, s);
+		return stream;
+	};
+
+	std::vector<std::byte> stream(1024);
+	Aead::chacha20_xor(stream, key, 1, nonce);
+	check_stream(stream, "chacha20_xor");
+	check_stream(run_kernel([](std::byte *p, const std::array<uint32_t, 16> &s) { Aead::chacha::xor_block(p, 64, s); }, 1), "scalar");
+#if defined(__x86_64__)
+	check_stream(run_kernel(Aead::chacha::xor_blocks_sse2, 4), "SSE2");
+	if(Aead::chacha::use_avx2)
+		check_stream(run_kernel(Aead::chacha::xor_blocks_avx2, 8), "AVX2");
+#endif
+}
+
+std::vector<std::byte> seal_stream(const Aead::key_type &key, size_t chunk_size, std::span<const std::byte> data)
+{
+	Aead::StreamEncryptor encryptor(key, chunk_size);
+	std::vector<std::byte> out;
+	encryptor.update(data, out);
+	encryptor.finish(out);
+	return out;
+}
+
+// fed in pieces of 7 bytes, so chunks arrive split at every offset
+std::vector<std::byte> open_stream(const Aead::key_type &key, size_t chunk_size, std::span<const std::byte> sealed)
+{
+	Aead::StreamDecryptor decryptor(key, chunk_size);
+	std::vector<std::byte> out;
+	for(size_t i=0;i<sealed.size();i+=7)
+		decryptor.update(sealed.subspan(i, std::min<size_t>(7, sealed.size()-i)), out);
+	decryptor.finish(out);
+	return out;
+}
+
+// StreamEncryptor and StreamDecryptor: an empty stream is one empty chunk, a stream of exactly chunk_size bytes one
+// full last chunk, and a dropped last chunk or swapped chunks don't open
+void check_streams()
+{
+	constexpr const size_t chunk_size = 64, sealed_chunk = chunk_size+Aead::tag_size;
+	Aead::key_type key;
+	Padding::random_bytes(key);
+
+	const std::vector<std::byte> empty = seal_stream(key, chunk_size, {});
+	check(empty.size() == Aead::tag_size, "stream empty size");
+	check(open_stream(key, chunk_size, empty).empty(), "stream empty round trip");
+	check(throws<Aead::authentication_error>([&] { open_stream(key, chunk_size, {}); }), "stream without its empty chunk");
+	check(throws<Aead::stream_error>([&] { Aead::StreamDecryptor(key, Aead::max_chunk_size+1); }), "stream chunk size too large");
+
+	std::vector<std::byte> message(chunk_size);
+	Padding::random_bytes(message);
+	const std::vector<std::byte> one_chunk = seal_stream(key, chunk_size, message);
+	check(one_chunk.size() == sealed_chunk, "stream of one chunk_size size");
+	check(open_stream(key, chunk_size, one_chunk) == message, "stream of one chunk_size round trip");
+
+	message.resize(3*chunk_size+chunk_size/2);
+	Padding::random_bytes(message);
+	const std::vector<std::byte> sealed = seal_stream(key, chunk_size, message);
+	check(sealed.size() == message.size()+4*Aead::tag_size, "stream of four chunks size");
+	check(open_stream(key, chunk_size, sealed) == message, "stream of four chunks round trip");
+
+	// without the last chunk the stream ends on a full chunk that isn't marked as the last one
+	const std::vector<std::byte> dropped(sealed.begin(), sealed.begin()+3*sealed_chunk);
+	check(throws<Aead::authentication_error>([&] { open_stream(key, chunk_size, dropped); }), "stream dropped last chunk");
+
+	std::vector<std::byte> swapped = sealed;
+	std::swap_ranges(swapped.begin(), swapped.begin()+sealed_chunk, swapped.begin()+sealed_chunk);
+	check(throws<Aead::authentication_error>([&] { open_stream(key, chunk_size, swapped); }), "stream swapped chunks");
+}
+
+// BigUint<bits> from limbs of rng, the top limb masked to top_bits bits
 template<typename uint_type>
-class Rsa
+uint_type random_limbs(std::mt19937_64 &rng, unsigned top_bits = 64)
 {
-	public:
-    uint_type gen_pub_key(uint_type eulers_totient, uint_type p, uint_type q)
-    {
-        // use random to have a non-const starting point
-        uint_type pubkey;
-		bool error;
-            
-        // pubkey has to be co-prime of n
-        for(uint_type c=uint_type::random("2", p<<uint16_t(1u), error);c<eulers_totient;c++) {
-            if(eulers_totient%c != "0") {
-                if(c != q && c != p) {
-                    // make sure c is prime using fermat's little theorem
-                    if((pow(uint_type(2),c-"1"))%c == "1") {
-                        pubkey = c;
-                        break;
-                    }
-                }
-            } else {
-                // if loop ended and no public key found
-                // generate new starting value
-                if(c == eulers_totient-"1") {
-                    c = uint_type::random("2", p<<uint16_t(1u), error);
-                }
-            }
-        }
-        
-        return pubkey;
-    }
+	uint_type ret;
+	uint64_t *op = ret.__get_op();
+	for(size_t i=0;i<uint_type::__get_op_size();i++) op[i] = rng();
+	if(top_bits < 64) op[0] &= (uint64_t(1) << top_bits)-1;
+	ret.normalize();
+	return ret;
+}
 
-    uint_type gen_priv_key(uint_type eulers_totient, uint_type pub_key)
-    {
-        //  e*d mod ϕ(n) = 1
-        uint_type privkey = 1;
-        while(privkey%pub_key != "0") {
-			std::cout << std::endl << privkey << std::endl;
-            privkey+=eulers_totient;
-        }
-        privkey/=pub_key;
-        return privkey;
-    }
-    
-    // check if private key is suitable for use
-    bool verify_priv_key_use(uint_type eulers_totient, uint_type pub_key,
-                             uint_type priv_key, uint_type n)
-    {
-        bool valid_priv_key = pub_key*priv_key %
-                              eulers_totient == "1";
-        return valid_priv_key;
-    }
-    
-    bool verify_pubkey_use(uint_type pubkey, uint_type eulers_totient)
-    {
-        int issue_count = 0;
-        // check if pubkey is bigger than 2
-        if(pubkey <= "2") {
-            std::cout << "\npubkey smaller than 2";
-            issue_count++;
-        }
-        
-        // check if gcd is one
-        for(uint_type c=2;c<eulers_totient;c++) {
-            if(eulers_totient%c=="0" && pubkey%c=="0") {
-                std::cout << "\ngcd is not one";
-                issue_count++;
-                break;
-            }
-        }
-        if(issue_count == 0)
-            return true;
-        return false;
-    }
+// the limb kernels under every kernel set the cpu has: products and squares at sizes on both sides of the Karatsuba
+// and Toom-3 thresholds, checked against the schoolbook product, and Montgomery products and powmods with odd and
+// even moduli. Every kernel set has to give the same limbs
+void check_kernel_sets()
+{
+	namespace limb = BigInt::limb;
+	typedef BigInt::BigUint<2048> uint_type;
+	const size_t max_n = limb::sqr_toom3_threshold+1;
+	const std::vector<size_t> sizes = {1, 2, limb::karatsuba_threshold-1, limb::karatsuba_threshold, limb::karatsuba_threshold+1,
+		limb::sqr_karatsuba_threshold-1, limb::sqr_karatsuba_threshold, limb::sqr_karatsuba_threshold+1,
+		limb::toom3_threshold-1, limb::toom3_threshold, limb::toom3_threshold+1,
+		limb::sqr_toom3_threshold-1, limb::sqr_toom3_threshold, limb::sqr_toom3_threshold+1};
+
+	auto run = [&](const std::string &name) {
+		std::mt19937_64 rng(1);
+		std::vector<uint64_t> a(max_n), b(max_n), r(2*max_n), basecase(2*max_n), out;
+		std::vector<uint64_t> scratch(std::max({limb::mul_n_scratch_size_upto(max_n), limb::sqr_n_scratch_size_upto(max_n),
+			limb::mul_scratch_size_upto(max_n)}));
+		for(uint64_t &x : a) x = rng();
+		for(uint64_t &x : b) x = rng();
+		for(size_t n : sizes) {
+			limb::mul_basecase(basecase.data(), a.data(), n, b.data(), n);
+			limb::mul_n(r.data(), a.data(), b.data(), n, scratch.data());
+			check(std::equal(r.begin(), r.begin()+2*n, basecase.begin()), name + " mul_n of " + std::to_string(n) + " limbs");
+			out.insert(out.end(), r.begin(), r.begin()+2*n);
+
+			limb::mul_basecase(basecase.data(), a.data(), n, a.data(), n);
+			limb::sqr_n(r.data(), a.data(), n, scratch.data());
+			check(std::equal(r.begin(), r.begin()+2*n, basecase.begin()), name + " sqr_n of " + std::to_string(n) + " limbs");
+			out.insert(out.end(), r.begin(), r.begin()+2*n);
+
+			const size_t bn = n/3+1;
+			limb::mul(r.data(), a.data(), n, b.data(), bn, scratch.data());
+			out.insert(out.end(), r.begin(), r.begin()+n+bn);
+		}
 
-	void encrypt(std::string plaintext, uint_type n,
-                        uint_type pub_key, uint_type *ct)
-	{
-        std::string ciphertext;
-        std::stringstream ss;
-        
-		// encrypt data byte by byte
-        for(size_t i=0;i<plaintext.length();i++) {
-            ct[i] = (uint_type)pow(uint_type(plaintext[i]-48),
-                                   pub_key) % n;
-        }
+		const uint_type odd = random_limbs<uint_type>(rng) | uint_type(1);
+		uint_type even = odd;
+		even -= uint_type(1);
+		const uint_type x = random_limbs<uint_type>(rng, 60), y = random_limbs<uint_type>(rng, 60);
+		const uint_type exp = random_limbs<uint_type>(rng);
+		const BigInt::MontgomeryContext<uint_type> ctx(odd);
+		for(const uint_type &v : {ctx.mont_mul(x, y), ctx.mont_sqr(x), BigInt::powmod(x, exp, odd), BigInt::powmod(x, exp, even),
+		                          BigInt::powmod_ct(x, exp, ctx)})
+			out.insert(out.end(), v.__get_op(), v.__get_op()+uint_type::__get_op_size());
+		return out;
+	};
+
+	const limb::kernel_set detected = limb::active_kernel_set();
+	limb::select_kernel_set(limb::kernel_set::portable);
+	const std::vector<uint64_t> portable = run("portable");
+	if(limb::select_kernel_set(limb::kernel_set::mulx_adx))
+		check(run("mulx_adx") == portable, "mulx_adx kernels give the limbs of the portable ones");
+	limb::select_kernel_set(detected);
+}
+
+// powmod_batch under every batch kernel the cpu has, against one powmod per job: odd moduli fill whole lane groups and
+// leave a short tail, even moduli take the scalar path, moduli of several sizes and bases larger than their modulus
+void check_batch()
+{
+	typedef BigInt::BigUint<1024> uint_type;
+	std::mt19937_64 rng(2);
+	std::vector<BigInt::powmod_job<uint_type>> jobs(21);
+	std::vector<uint_type> expected;
+	for(size_t i=0;i<jobs.size();i++) {
+		auto &job = jobs[i];
+		job.mod = random_limbs<uint_type>(rng) >> uint16_t(i%4 * 200);
+		job.mod.__get_op()[uint_type::__get_op_size()-1] |= 1;
+		if(i%5 == 4) job.mod -= uint_type(1);
+		job.base = i%3 ? random_limbs<uint_type>(rng) : random_limbs<uint_type>(rng) >> uint16_t(900);
+		job.exp = random_limbs<uint_type>(rng) >> uint16_t(i*47);
+		expected.push_back(BigInt::powmod(job.base, job.exp, job.mod));
 	}
-    
-    std::string decrypt(std::string ciphertext, uint_type n, uint_type 
-                        priv_key) {
-        std::string plaintext = "";
-        std::stringstream ss_plaintxt;
-		auto mod = ciphertext.length()%64;
-		decltype(uint_type::__get_op_size()) substr_size = uint_type::__get_op_size()<<4;
-		decltype(uint_type::__get_op_size()) len = mod == 0 ? ciphertext.length()/substr_size :
-														  	  ciphertext.length()/substr_size+1;
-		uint_type *ct = new uint_type[len];
-
-		// parse and decrypt ciphertext
-		if(ciphertext.length() <= 64) {
-			ct[0] = ciphertext;
-
-            ss_plaintxt << (uint8_t)(pow(ct[0], (uint_type) priv_key)%n);
-		} else {
-        	for(decltype(uint_type::__get_op_size()) c=0;c<ciphertext.length()/substr_size;c++) {
-        	    ct[c] = ciphertext.substr(c*substr_size,c*substr_size+substr_size);
-        	    uint_type temp=0;
-
-				// decrypt
-            	ss_plaintxt << (uint8_t)((uint8_t)(pow(ct[0], (uint_type) priv_key)%n)+48);
-
-        	}
+
+	const BigInt::batch_kernel detected = BigInt::active_batch_kernel();
+	for(auto kernel : {BigInt::batch_kernel::scalar, BigInt::batch_kernel::avx2, BigInt::batch_kernel::avx512}) {
+		if(!BigInt::select_batch_kernel(kernel)) continue;
+		std::vector<uint_type> results(jobs.size());
+		BigInt::powmod_batch<uint_type>(jobs, results);
+		check(results == expected, std::string("powmod_batch under the ") + BigInt::batch_kernel_name(kernel) + " kernel");
+	}
+	BigInt::select_batch_kernel(detected);
+}
+
+// stream operators read back what they wrote in the stream's base, from_string reads every base
+void check_string_io()
+{
+	typedef BigInt::BigUint<1024> uint_type;
+	const uint_type big = uint_type::random(uint_type(1) << uint16_t(1000));
+	for(const uint_type &a : {uint_type(0), uint_type(0x1234abcd), big}) {
+		for(std::ios_base::fmtflags base : {std::ios_base::dec, std::ios_base::hex, std::ios_base::oct}) {
+			std::stringstream ss;
+			ss.setf(base, std::ios_base::basefield);
+			uint_type b, c;
+			ss << a << ' ' << a;
+			ss >> b >> c;
+			check(b == a && c == a, "stream round trip");
 		}
-        plaintext = ss_plaintxt.str();
-		delete[] ct;
-        return plaintext;
-    }
-};
+	}
+	check(uint_type::from_string("305441741", 10) == uint_type(0x1234abcd), "from_string decimal");
+	check(uint_type::from_string("1234abcd") == uint_type(0x1234abcd), "from_string hex");
+	check(uint_type::from_string("777", 8) == uint_type(511), "from_string octal");
+	check(throws<BigInt::wrong_type_error>([] { uint_type::from_string("12ab", 10); }), "from_string rejects hex digits in decimal");
+}
+
+int self_check()
+{
+	// OAEP-SHA256 needs blocks of at least 66 bytes, three primes need 1024 bits
+	typedef BigInt::BigUint<1024> uint_type;
+	auto rsa = Rsa<uint_type>();
+	const auto keys = rsa.generate_keypair(1024);
+	const auto crt = rsa.gen_crt_key(keys.p, keys.q, keys.pub_key, keys.priv_key);
+	const auto multi_prime = rsa.generate_multi_prime_key(1024, 3);
 
-int main()
+	check_kernel_sets();
+	check_batch();
+	check_string_io();
+	check_message(rsa, keys, "keypair");
+	check_message(rsa, crt, "crt_key");
+	check_message(rsa, multi_prime, "multi_prime_key");
+	check_hybrid(rsa, keys, "keypair");
+	check_hybrid(rsa, crt, "crt_key");
+	check_hybrid(rsa, multi_prime, "multi_prime_key");
+	check_aead_vectors();
+	check_keystream();
+	check_streams();
+
+	if(check_failures) {
+		std::cout << std::dec << check_failures << " checks failed" << std::endl;
+		return 1;
+	}
+	std::cout << "all checks passed" << std::endl;
+	return 0;
+}
+
+int main(int argc, char **argv)
 {
+	if(argc > 1 && std::string(argv[1]) == "check")
+		return self_check();
+
 	typedef BigInt::BigUint<256> uint_type;
     uint_type pubkey, q, p, priv_key,n;
     std::string plaintext, ciphertext;
@@ -140,7 +396,8 @@ int main()
     bool privkey_usable = false;
     bool q_prime = true;
     bool p_prime = true;
-	std::cout << "\nIMPORTANT: ALL NUMBERS ARE HEX";
+	std::cout << std::hex << "\nIMPORTANT: ALL NUMBERS ARE HEX"; // BigUints print and parse in the stream's base
+	std::cin >> std::hex;
 
 	// test
 	// q = 7
@@ -170,9 +427,8 @@ int main()
 	 		goto wrong_inp;
 	 	}
 
-         // use fermat's little theorem to find if q is a prime number
-         uint_type a = 2;
-         q_prime = pow(a,q-uint_type("1"))%q == "1";
+         // small prime sieve and Miller-Rabin
+         q_prime = BigInt::is_probable_prime(q);
 	 	std::cout << std::endl << "is " << q << " prime: " << q_prime;
      } while(!q_prime);
      do {
@@ -185,14 +441,13 @@ int main()
 	 		goto wrong_inp_p;
 	 	}
 
-         // use fermat's little theorem to find if q is a prime number
-         uint_type a = 2;
-         p_prime = (uint_type)(pow(a,p-"1"))%p == "1";
+         // small prime sieve and Miller-Rabin
+         p_prime = BigInt::is_probable_prime(p);
 	 	std::cout << std::endl << "is " << p << " prime: " << p_prime;
      } while(!p_prime);
 
      // calculate Euler's totient since p and q are defined
-     uint_type eulers_totient = (p-"1")*(q-"1");
+     uint_type eulers_totient = (p-uint_type(1))*(q-uint_type(1));
      n = q*p;
 
      // get public key
@@ -207,7 +462,7 @@ int main()
              std::cin.ignore(std::numeric_limits
                              <std::streamsize>::max(), '\n');
              pubkey = rsa.gen_pub_key(eulers_totient,p,q);
-             std::cout << "\npubkey:\t" << std::dec << pubkey
+             std::cout << "\npubkey:\t" << pubkey
                        << std::endl;
              pubkey_usable = true;
 	 		std::cout << std::endl << "is " << p << " usable public key: " << pubkey_usable;
@@ -235,7 +490,7 @@ int main()
              std::cin.ignore(std::numeric_limits
                              <std::streamsize>::max(), '\n');
              priv_key = rsa.gen_priv_key(eulers_totient, pubkey);
-             std::cout << "\nprivkey:\t" << std::dec << priv_key
+             std::cout << "\nprivkey:\t" << priv_key
                        << std::endl;
              privkey_usable = true;
 	 		catched=true;
@@ -270,7 +525,8 @@ int main()
         std::string plaintext;
         std::cout << "\ninput ciphertext:\t";
         std::cin >> ciphertext;
-        plaintext = rsa.decrypt(ciphertext, n, priv_key);
+        // two half-size exponentiations with the factors instead of one over n
+        plaintext = rsa.decrypt(ciphertext, rsa.gen_crt_key(p, q, pubkey, priv_key));
         std::cout << "\nplaintext:\t " << std::dec << plaintext << std::endl;
     }
 }
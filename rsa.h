@@ -0,0 +1,579 @@
+#ifndef RSA_H
+#define RSA_H
+
+#include <iostream>
+#include <string>
+#include <stdint.h>
+#include <span>
+#include <cstddef>
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <array>
+
+#include "bigint.h"
+#include "modular.h"
+#include "prime.h"
+#include "padding.h"
+#include "sha256.h"
+#include "chacha20poly1305.h"
+
+// raise when a CRT private key operation doesn't re-encrypt to its input. Releasing a result with a fault in one
+// of the two halves would give away a factor of n as gcd(result^e - input, n)
+class crt_fault_error : public std::runtime_error {
+	public: explicit crt_fault_error(const char *str) : std::runtime_error(str) {}
+};
+
+// raise when a binary ciphertext doesn't have the layout encrypt_message writes or doesn't belong to the key
+class ciphertext_format_error : public std::runtime_error {
+	public: explicit ciphertext_format_error(const char *str) : std::runtime_error(str) {}
+};
+
+// Rivest Shamir & Adleman
+template<typename uint_type>
+class Rsa
+{
+	public:
+    uint_type gen_pub_key(uint_type eulers_totient, uint_type p, uint_type q)
+    {
+        // use random to have a non-const starting point
+        uint_type pubkey;
+		bool error;
+            
+        // pubkey has to be co-prime of n
+        for(uint_type c=uint_type::random(2, p<<uint16_t(1u), error);c<eulers_totient;c++) {
+            if(BigInt::gcd(eulers_totient, c).is_one()) {
+                if(c != q && c != p) {
+                    // make sure c is prime, small prime sieve and Miller-Rabin
+                    if(BigInt::is_probable_prime(c)) {
+                        pubkey = c;
+                        break;
+                    }
+                }
+            } else {
+                // if loop ended and no public key found
+                // generate new starting value
+                if(c == eulers_totient-uint_type(1)) {
+                    c = uint_type::random(2, p<<uint16_t(1u), error);
+                }
+            }
+        }
+        
+        return pubkey;
+    }
+
+    uint_type gen_priv_key(uint_type eulers_totient, uint_type pub_key)
+    {
+        //  e*d mod ϕ(n) = 1
+        return BigInt::mod_inverse(pub_key, eulers_totient);
+    }
+
+	struct keypair
+	{
+		uint_type n, pub_key, priv_key, p, q;
+	};
+
+	// private key for the Chinese remainder theorem, the RSAPrivateKey fields of PKCS #1. n and pub_key are kept
+	// for the fault check, the Montgomery contexts for the constant time private key operation
+	struct crt_key
+	{
+		uint_type n, pub_key, p, q;
+		uint_type dP, dQ; // priv_key mod p-1 and mod q-1
+		uint_type qInv; // q^-1 mod p
+		BigInt::MontgomeryContext<uint_type> ctx_p, ctx_q, ctx_n;
+	};
+
+	// dP, dQ, qInv and the contexts once per key, so every private key operation only runs the two half-size exponentiations
+	crt_key gen_crt_key(uint_type p, uint_type q, const uint_type &pub_key, const uint_type &priv_key)
+	{
+		const uint_type one = 1, n = p*q;
+		uint_type d = priv_key;
+		return crt_key{
+			.n = n, .pub_key = pub_key, .p = p, .q = q,
+			.dP = d % (p-one), .dQ = d % (q-one),
+			.qInv = BigInt::mod_inverse(q, p),
+			.ctx_p = BigInt::MontgomeryContext<uint_type>(p),
+			.ctx_q = BigInt::MontgomeryContext<uint_type>(q),
+			.ctx_n = BigInt::MontgomeryContext<uint_type>(n)
+		};
+	}
+
+	// one prime of a multi-prime key (RFC 8017): the prime r, its exponent d = priv_key mod r-1, the Garner
+	// coefficient (r_1*...*r_(i-1))^-1 mod r, unused for the first prime, and the Montgomery context of r
+	struct prime_factor
+	{
+		uint_type r, d, coeff;
+		BigInt::MontgomeryContext<uint_type> ctx;
+	};
+
+	struct multi_prime_key
+	{
+		uint_type n, pub_key, priv_key;
+		std::vector<prime_factor> factors;
+		BigInt::MontgomeryContext<uint_type> ctx_n;
+	};
+
+	// most primes for an n of bits bits, so none gets small enough for factoring methods that look for small factors.
+	// The same limits as OpenSSL
+	static constexpr size_t max_primes(size_t bits)
+	{
+		return bits < 1024 ? 2 : bits < 4096 ? 3 : bits < 8192 ? 4 : 5;
+	}
+
+	// exponents and coefficients for the primes in this order, the primes have to be distinct
+	multi_prime_key gen_multi_prime_key(const std::vector<uint_type> &primes, const uint_type &pub_key, const uint_type &priv_key)
+	{
+		const uint_type one = 1;
+		uint_type d = priv_key, n = one;
+		std::vector<prime_factor> factors;
+		for(uint_type r : primes) {
+			uint_type coeff = factors.empty() ? uint_type(0) : BigInt::mod_inverse(n, r);
+			factors.push_back(prime_factor{.r = r, .d = d % (r-one), .coeff = coeff, .ctx = BigInt::MontgomeryContext<uint_type>(r)});
+			n *= r;
+		}
+		return multi_prime_key{
+			.n = n, .pub_key = pub_key, .priv_key = priv_key,
+			.factors = std::move(factors),
+			.ctx_n = BigInt::MontgomeryContext<uint_type>(n)
+		};
+	}
+
+	// random key with an n of exactly bits bits from primes distinct primes of about bits/primes bits each, public key
+	// 65537. Every prime search runs at the same time on threads/primes workers. primes has to be between 2 and
+	// max_primes(bits), otherwise prime_size_error is thrown
+	multi_prime_key generate_multi_prime_key(size_t bits, size_t primes, size_t threads = std::thread::hardware_concurrency())
+	{
+		if(bits < 32 || bits > 64*uint_type::__get_op_size())
+			throw BigInt::prime_size_error("generate_multi_prime_key bit size has to be between 32 and the bitsize of the type");
+		if(primes < 2 || primes > max_primes(bits))
+			throw BigInt::prime_size_error("generate_multi_prime_key has too many primes for the bit size");
+		threads = std::max<size_t>(threads, 1);
+
+		auto prime_bits = [&](size_t i) { return bits/primes + (i < bits%primes); };
+		const uint_type one = 1, pub_key = 65537;
+		std::vector<uint_type> r(primes);
+		while(true) {
+			if(threads == 1) {
+				for(size_t i=0;i<primes;i++)
+					r[i] = BigInt::generate_prime<uint_type>(prime_bits(i));
+			} else {
+				const size_t workers = std::max<size_t>(threads/primes, 1);
+				std::vector<std::jthread> searches;
+				for(size_t i=1;i<primes;i++)
+					searches.emplace_back([&, i] { r[i] = BigInt::generate_prime<uint_type>(prime_bits(i), workers); });
+				r[0] = BigInt::generate_prime<uint_type>(prime_bits(0), workers);
+			}
+
+			uint_type n = one, eulers_totient = one;
+			bool usable = true;
+			for(size_t i=0;i<primes;i++) {
+				uint_type r_1 = r[i]-one;
+				usable &= BigInt::gcd(pub_key, r_1).is_one();
+				for(size_t j=0;j<i;j++)
+					usable &= r[i] != r[j];
+				n *= r[i];
+				eulers_totient *= r_1;
+			}
+			// the top two bits of every prime only guarantee the full size of n for two of them, more can fall a bit short
+			if(!usable || BigInt::limb::bit_length(n.__get_op(), uint_type::__get_op_size()) != bits)
+				continue;
+			return gen_multi_prime_key(r, pub_key, gen_priv_key(eulers_totient, pub_key));
+		}
+	}
+
+	// random keypair with an n of exactly bits bits and public key 65537, no interactive input. p and q are searched
+	// at the same time on half of threads each, every search splits its candidates across its workers (see
+	// BigInt::generate_prime). threads 1 searches p and q one after another on the calling thread
+	keypair generate_keypair(size_t bits, size_t threads = std::thread::hardware_concurrency())
+	{
+		if(bits < 32 || bits > 64*uint_type::__get_op_size())
+			throw BigInt::prime_size_error("generate_keypair bit size has to be between 32 and the bitsize of the type");
+		threads = std::max<size_t>(threads, 1);
+
+		// both primes have their top two bits set, so n = p*q has exactly p_bits+q_bits bits
+		const size_t p_bits = (bits+1)/2, q_bits = bits/2;
+		const uint_type one = 1, pub_key = 65537;
+		while(true) {
+			uint_type p, q;
+			if(threads == 1) {
+				p = BigInt::generate_prime<uint_type>(p_bits);
+				q = BigInt::generate_prime<uint_type>(q_bits);
+			} else {
+				std::jthread q_search([&] { q = BigInt::generate_prime<uint_type>(q_bits, threads/2); });
+				p = BigInt::generate_prime<uint_type>(p_bits, threads-threads/2);
+			}
+
+			// the public key has to be invertible mod ϕ(n), rare enough to just draw both primes again
+			uint_type p_1 = p-one, q_1 = q-one;
+			if(p == q || !BigInt::gcd(pub_key, p_1).is_one() || !BigInt::gcd(pub_key, q_1).is_one())
+				continue;
+			uint_type eulers_totient = p_1*q_1;
+			return keypair{p*q, pub_key, gen_priv_key(eulers_totient, pub_key), p, q};
+		}
+	}
+    
+    // check if private key is suitable for use
+    bool verify_priv_key_use(uint_type eulers_totient, uint_type pub_key,
+                             uint_type priv_key, uint_type n)
+    {
+        bool valid_priv_key = mulmod(pub_key, priv_key,
+                                     eulers_totient).is_one();
+        return valid_priv_key;
+    }
+    
+    bool verify_pubkey_use(uint_type pubkey, uint_type eulers_totient)
+    {
+        int issue_count = 0;
+        // check if pubkey is bigger than 2
+        if(pubkey.cmp(2) <= 0) {
+            std::cout << "\npubkey smaller than 2";
+            issue_count++;
+        }
+        
+        // check if gcd is one
+        if(!BigInt::gcd(pubkey, eulers_totient).is_one()) {
+            std::cout << "\ngcd is not one";
+            issue_count++;
+        }
+        if(issue_count == 0)
+            return true;
+        return false;
+    }
+
+	// one exponentiation per character, for the interactive demo whose keys are too short to pad (see encrypt_message)
+	void encrypt(std::string plaintext, uint_type n,
+                        uint_type pub_key, uint_type *ct)
+	{
+		// encrypt data byte by byte
+        for(size_t i=0;i<plaintext.length();i++) {
+            ct[i] = powmod(uint_type(plaintext[i]-48),
+                           pub_key, n);
+        }
+	}
+
+	// bytes of one ciphertext block, the length of n like I2OSP in PKCS #1
+	static size_t block_size(const uint_type &n)
+	{
+		return (BigInt::limb::bit_length(n.__get_op(), uint_type::__get_op_size())+7)/8;
+	}
+
+	// encrypt into fixed-length big-endian blocks of block_size(n) bytes, one per plaintext byte.
+	// out has to hold plaintext.length()*block_size(n) bytes
+	void encrypt(const std::string &plaintext, uint_type n, uint_type pub_key, std::span<std::byte> out)
+	{
+		const size_t size = block_size(n);
+		for(size_t i=0;i<plaintext.length();i++)
+			powmod(uint_type(plaintext[i]-48), pub_key, n).to_bytes(out.subspan(i*size, size));
+	}
+
+	// decrypt blocks of block_size(n) bytes straight from a network or file buffer, no hex round trip
+	std::string decrypt(std::span<const std::byte> ciphertext, uint_type n, uint_type priv_key)
+	{
+		const size_t size = block_size(n);
+		std::string plaintext;
+		for(size_t c=0;c+size<=ciphertext.size();c+=size)
+			plaintext += decrypt_block(uint_type::from_bytes(ciphertext.subspan(c, size)), n, priv_key);
+		return plaintext;
+	}
+
+	// hex blocks of op_size*16 digits as printed by main, the last one can be shorter
+    std::string decrypt(std::string ciphertext, uint_type n, uint_type 
+                        priv_key) {
+		const size_t substr_size = uint_type::__get_op_size()<<4;
+        std::string plaintext;
+		for(size_t c=0;c<ciphertext.length();c+=substr_size)
+			plaintext += decrypt_block(uint_type(ciphertext.substr(c, substr_size)), n, priv_key);
+        return plaintext;
+    }
+
+	// decrypt or sign primitive c^priv_key mod n over the full modulus (RSADP, RSASP1)
+	uint_type private_op(const uint_type &c, const uint_type &n, const uint_type &priv_key)
+	{
+		return BigInt::powmod_ct(c, priv_key, n);
+	}
+
+	uint_type private_op(const uint_type &c, const keypair &key)
+	{
+		return private_op(c, key.n, key.priv_key);
+	}
+
+	// the same with the CRT key: c^dP mod p and c^dQ mod q at half the size, combined with Garner's formula
+	// m = m2 + q*(qInv*(m1-m2) mod p). Every step runs in constant time on the cached contexts, neither p, q nor the
+	// exponents show in the run time. fault_check encrypts the result again with pub_key (see check_fault), it costs
+	// one exponentiation by the short public key
+	uint_type private_op(const uint_type &c, const crt_key &key, bool fault_check = true)
+	{
+		const uint_type m1 = BigInt::powmod_ct(key.ctx_p.reduce(c), key.dP, key.ctx_p);
+		const uint_type m2 = BigInt::powmod_ct(key.ctx_q.reduce(c), key.dQ, key.ctx_q);
+
+		// m2 can be larger than p. qInv in Montgomery form makes mont_mul give qInv*diff mod p
+		const uint_type diff = key.ctx_p.mod_sub(m1, key.ctx_p.reduce(m2));
+		const uint_type h = key.ctx_p.mont_mul(key.ctx_p.to_mont(key.qInv), diff);
+
+		// h*q+m2 is less than n, so the products and the sum mod n are the exact values
+		const uint_type m = key.ctx_n.mod_add(key.ctx_n.mont_mul(key.ctx_n.to_mont(h), key.q), m2);
+
+		if(fault_check)
+			check_fault(c, m, key.ctx_n, key.pub_key);
+		return m;
+	}
+
+	// the same with a multi-prime key, c^d mod r for every prime and Garner's formula prime by prime: the result so far
+	// is c^priv_key mod R = r_1*...*r_(i-1) and moves to mod R*r_i with m + R*(coeff*(m_i-m) mod r_i). Constant time
+	// on the cached contexts like the CRT key. parallel runs the exponentiations on a thread per prime, for the latency
+	// of a single operation
+	uint_type private_op(const uint_type &c, const multi_prime_key &key, bool fault_check = true, bool parallel = false)
+	{
+		const size_t k = key.factors.size();
+		std::vector<uint_type> m(k);
+		auto exponentiate = [&](size_t i) {
+			const prime_factor &f = key.factors[i];
+			m[i] = BigInt::powmod_ct(f.ctx.reduce(c), f.d, f.ctx);
+		};
+		if(parallel) {
+			std::vector<std::jthread> workers;
+			for(size_t i=1;i<k;i++)
+				workers.emplace_back(exponentiate, i);
+			exponentiate(0);
+		} else {
+			for(size_t i=0;i<k;i++)
+				exponentiate(i);
+		}
+
+		// R*h+ret is less than R*r_i, which divides n, so the steps mod n give the exact values
+		uint_type ret = m[0], mod = key.factors[0].r;
+		for(size_t i=1;i<k;i++) {
+			const prime_factor &f = key.factors[i];
+			const uint_type diff = f.ctx.mod_sub(m[i], f.ctx.reduce(ret));
+			const uint_type h = f.ctx.mont_mul(f.ctx.to_mont(f.coeff), diff);
+			ret = key.ctx_n.mod_add(key.ctx_n.mont_mul(key.ctx_n.to_mont(h), mod), ret);
+			mod *= f.r;
+		}
+
+		if(fault_check)
+			check_fault(c, ret, key.ctx_n, key.pub_key);
+		return ret;
+	}
+
+	// decrypt with the CRT key, the ciphertext formats of the other decrypt overloads
+	std::string decrypt(std::span<const std::byte> ciphertext, const crt_key &key, bool fault_check = true)
+	{
+		const size_t size = block_size(key.n);
+		std::string plaintext;
+		for(size_t c=0;c+size<=ciphertext.size();c+=size)
+			plaintext += decrypt_block(private_op(uint_type::from_bytes(ciphertext.subspan(c, size)), key, fault_check));
+		return plaintext;
+	}
+
+	std::string decrypt(const std::string &ciphertext, const crt_key &key, bool fault_check = true)
+	{
+		const size_t substr_size = uint_type::__get_op_size()<<4;
+		std::string plaintext;
+		for(size_t c=0;c<ciphertext.length();c+=substr_size)
+			plaintext += decrypt_block(private_op(uint_type(ciphertext.substr(c, substr_size)), key, fault_check));
+		return plaintext;
+	}
+
+	// binary ciphertext of encrypt_message: a header of "RSA", version 1, the padding scheme, a zero byte and the block
+	// size k in 2 bytes big endian, then one block of k bytes per chunk of the message
+	constexpr static size_t message_header_size = 8;
+
+	// message packed into chunks of Padding::max_message_size bytes, each padded to a block of block_size(n) bytes and
+	// encrypted with one exponentiation, instead of one per character. An empty message still gets one block
+	std::vector<std::byte> encrypt_message(std::span<const std::byte> message, const uint_type &n, const uint_type &pub_key,
+		Padding::scheme s = Padding::scheme::oaep)
+	{
+		const size_t k = block_size(n), chunk = Padding::max_message_size(s, k);
+		if(chunk == 0)
+			throw Padding::padding_error("modulus too short for the padding scheme");
+		const size_t blocks = std::max<size_t>((message.size()+chunk-1)/chunk, 1);
+
+		std::vector<std::byte> out(message_header_size+blocks*k);
+		const std::array<std::byte, message_header_size> header = {std::byte('R'), std::byte('S'), std::byte('A'), std::byte(1),
+			std::byte(s), std::byte(0), std::byte(k >> 8), std::byte(k)};
+		std::copy(header.begin(), header.end(), out.begin());
+
+		// n of an RSA key is odd, one Montgomery context for every block
+		const BigInt::MontgomeryContext<uint_type> ctx(n);
+		std::vector<std::byte> em(k);
+		for(size_t i=0;i<blocks;i++) {
+			const size_t offset = i*chunk;
+			Padding::pad(s, em, message.subspan(offset, std::min(chunk, message.size()-offset)));
+			BigInt::powmod(uint_type::from_bytes(em), pub_key, ctx).to_bytes(std::span<std::byte>(out).subspan(message_header_size+i*k, k));
+		}
+		return out;
+	}
+
+	// message of an encrypt_message ciphertext with any private key: keypair, crt_key or multi_prime_key. Throws
+	// ciphertext_format_error for a bad header or length and Padding::padding_error for a block that doesn't decrypt
+	template<typename key_type>
+	std::vector<std::byte> decrypt_message(std::span<const std::byte> ciphertext, const key_type &key)
+	{
+		const size_t k = block_size(key.n);
+		if(ciphertext.size() < message_header_size+k || (ciphertext.size()-message_header_size)%k != 0)
+			throw ciphertext_format_error("ciphertext length isn't a header and whole blocks");
+		const std::span<const std::byte> header = ciphertext.first(message_header_size);
+		if(header[0] != std::byte('R') || header[1] != std::byte('S') || header[2] != std::byte('A') || header[3] != std::byte(1))
+			throw ciphertext_format_error("not a version 1 RSA ciphertext");
+		const Padding::scheme s = Padding::scheme(header[4]);
+		if((s != Padding::scheme::pkcs1_v15 && s != Padding::scheme::oaep) || header[5] != std::byte(0))
+			throw ciphertext_format_error("unknown padding scheme");
+		if((size_t(header[6]) << 8 | size_t(header[7])) != k)
+			throw ciphertext_format_error("block size doesn't match the key");
+
+		std::vector<std::byte> message, em(k);
+		for(size_t c=message_header_size;c<ciphertext.size();c+=k) {
+			uint_type block = uint_type::from_bytes(ciphertext.subspan(c, k));
+			if(block >= key.n)
+				throw Padding::padding_error("decryption error");
+			private_op(block, key).to_bytes(em);
+			const std::vector<std::byte> part = Padding::unpad(s, em);
+			message.insert(message.end(), part.begin(), part.end());
+		}
+		return message;
+	}
+
+	// RSA-KEM (RFC 5990): a random z < n is encrypted as it is, no padding, and the session key is KDF2-SHA256(z)
+	struct kem_result
+	{
+		Aead::key_type key;
+		std::vector<std::byte> ciphertext; // block_size(n) bytes
+	};
+
+	kem_result kem_encapsulate(const uint_type &n, const uint_type &pub_key)
+	{
+		const uint_type one = 1;
+		uint_type n_1 = n;
+		n_1 -= one;
+		const size_t k = block_size(n);
+		const uint_type z = uint_type::random(n_1);
+		std::vector<std::byte> z_bytes(k);
+		z.to_bytes(z_bytes);
+		kem_result ret{kem_kdf(z_bytes), std::vector<std::byte>(k)};
+		powmod(z, pub_key, n).to_bytes(ret.ciphertext);
+		return ret;
+	}
+
+	// session key of a kem_encapsulate ciphertext with any private key. A wrong ciphertext gives a wrong key, which
+	// the tag of the first chunk catches
+	template<typename key_type>
+	Aead::key_type kem_decapsulate(std::span<const std::byte> ciphertext, const key_type &key)
+	{
+		const size_t k = block_size(key.n);
+		if(ciphertext.size() != k)
+			throw ciphertext_format_error("KEM ciphertext isn't a block less than n");
+		uint_type c = uint_type::from_bytes(ciphertext);
+		if(c >= key.n)
+			throw ciphertext_format_error("KEM ciphertext isn't a block less than n");
+		std::vector<std::byte> z_bytes(k);
+		private_op(c, key).to_bytes(z_bytes);
+		return kem_kdf(z_bytes);
+	}
+
+	// Hybrid ciphertext: the header of encrypt_message with version 2 and scheme 0 followed by the chunk size in 4 bytes
+	// big endian, the KEM block of block_size(n) bytes and the Aead stream of the payload. The header is the associated
+	// data of every chunk, so neither the chunk size nor the key length can be swapped
+	constexpr static size_t hybrid_header_size = 12;
+	constexpr static size_t hybrid_chunk_size = 64*1024;
+
+	// bytes before the payload, header and KEM block
+	static size_t hybrid_prefix_size(const uint_type &n)
+	{
+		return hybrid_header_size+block_size(n);
+	}
+
+	// starts a hybrid ciphertext: appends the header and the KEM block to out and returns the encryptor for the payload,
+	// whose update and finish append the rest. One RSA operation however long the payload is
+	Aead::StreamEncryptor hybrid_encryptor(const uint_type &n, const uint_type &pub_key, std::vector<std::byte> &out,
+		size_t chunk_size = hybrid_chunk_size)
+	{
+		if(chunk_size == 0 || chunk_size > Aead::max_chunk_size)
+			throw Aead::stream_error("chunk size has to be between 1 byte and Aead::max_chunk_size");
+		const size_t k = block_size(n);
+		const std::array<std::byte, hybrid_header_size> header = {std::byte('R'), std::byte('S'), std::byte('A'), std::byte(2),
+			std::byte(0), std::byte(0), std::byte(k >> 8), std::byte(k), std::byte(chunk_size >> 24), std::byte(chunk_size >> 16),
+			std::byte(chunk_size >> 8), std::byte(chunk_size)};
+		const kem_result kem = kem_encapsulate(n, pub_key);
+		out.insert(out.end(), header.begin(), header.end());
+		out.insert(out.end(), kem.ciphertext.begin(), kem.ciphertext.end());
+		return Aead::StreamEncryptor(kem.key, chunk_size, header);
+	}
+
+	// reads the first hybrid_prefix_size(key.n) bytes of a hybrid ciphertext and returns the decryptor for the rest.
+	// Throws ciphertext_format_error for a header that doesn't fit the key or a chunk size above Aead::max_chunk_size
+	template<typename key_type>
+	Aead::StreamDecryptor hybrid_decryptor(std::span<const std::byte> prefix, const key_type &key)
+	{
+		const size_t k = block_size(key.n);
+		if(prefix.size() != hybrid_prefix_size(key.n))
+			throw ciphertext_format_error("hybrid ciphertext shorter than its header");
+		const std::span<const std::byte> header = prefix.first(hybrid_header_size);
+		if(header[0] != std::byte('R') || header[1] != std::byte('S') || header[2] != std::byte('A') || header[3] != std::byte(2)
+		   || header[4] != std::byte(0) || header[5] != std::byte(0))
+			throw ciphertext_format_error("not a version 2 RSA ciphertext");
+		if((size_t(header[6]) << 8 | size_t(header[7])) != k)
+			throw ciphertext_format_error("block size doesn't match the key");
+		const size_t chunk_size = size_t(header[8]) << 24 | size_t(header[9]) << 16 | size_t(header[10]) << 8 | size_t(header[11]);
+		// the header isn't authenticated before the first tag, so a forged chunk size mustn't make the decryptor buffer more
+		if(chunk_size == 0 || chunk_size > Aead::max_chunk_size)
+			throw ciphertext_format_error("hybrid chunk size out of range");
+		return Aead::StreamDecryptor(kem_decapsulate(prefix.subspan(hybrid_header_size), key), chunk_size, header);
+	}
+
+	// whole payloads in memory
+	std::vector<std::byte> hybrid_encrypt(std::span<const std::byte> message, const uint_type &n, const uint_type &pub_key,
+		size_t chunk_size = hybrid_chunk_size)
+	{
+		std::vector<std::byte> out;
+		out.reserve(hybrid_prefix_size(n)+message.size()+(message.size()/chunk_size+1)*Aead::tag_size);
+		Aead::StreamEncryptor encryptor = hybrid_encryptor(n, pub_key, out, chunk_size);
+		encryptor.update(message, out);
+		encryptor.finish(out);
+		return out;
+	}
+
+	template<typename key_type>
+	std::vector<std::byte> hybrid_decrypt(std::span<const std::byte> ciphertext, const key_type &key)
+	{
+		const size_t prefix = hybrid_prefix_size(key.n);
+		if(ciphertext.size() < prefix)
+			throw ciphertext_format_error("hybrid ciphertext shorter than its header");
+		Aead::StreamDecryptor decryptor = hybrid_decryptor(ciphertext.first(prefix), key);
+		std::vector<std::byte> message;
+		message.reserve(ciphertext.size()-prefix);
+		decryptor.update(ciphertext.subspan(prefix), message);
+		decryptor.finish(message);
+		return message;
+	}
+
+	protected:
+	// KDF2 with SHA-256 for a 32 byte key, a single SHA256(z || 00000001)
+	static Aead::key_type kem_kdf(std::span<const std::byte> z)
+	{
+		const std::array<std::byte, 4> counter = {std::byte(0), std::byte(0), std::byte(0), std::byte(1)};
+		Hash::Sha256 hash;
+		hash.update(z);
+		hash.update(counter);
+		return hash.finish();
+	}
+
+	// encrypts the result of a CRT private key operation again, throws crt_fault_error if it doesn't give c mod n
+	void check_fault(const uint_type &c, const uint_type &m, const BigInt::MontgomeryContext<uint_type> &ctx_n, const uint_type &pub_key)
+	{
+		if(BigInt::powmod(m, pub_key, ctx_n) != ctx_n.reduce(c))
+			throw crt_fault_error("CRT private key operation failed its fault check");
+	}
+
+	char decrypt_block(const uint_type &ct, const uint_type &n, const uint_type &priv_key)
+	{
+		return decrypt_block(private_op(ct, n, priv_key));
+	}
+
+	char decrypt_block(uint_type m)
+	{
+		return (uint8_t)((uint8_t)m+48);
+	}
+};
+
+#endif /* RSA_H */
@@ -0,0 +1,107 @@
+#ifndef SHA256_CPP
+#define SHA256_CPP
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <span>
+#include <bit>
+#include <algorithm>
+
+#include "sha256.h"
+
+namespace Hash
+{
+	// first 32 bits of the fractional parts of the cube roots of the first 64 primes
+	constexpr const std::array<uint32_t, 64> sha256_k = {
+		0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+		0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+		0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+		0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+		0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+		0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+		0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+		0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+	};
+
+	inline Sha256::Sha256()
+	{
+		reset();
+	}
+
+	inline void Sha256::reset()
+	{
+		// first 32 bits of the fractional parts of the square roots of the first 8 primes
+		state = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+		buffered = 0;
+		length = 0;
+	}
+
+	inline void Sha256::compress(const std::byte *block)
+	{
+		std::array<uint32_t, 64> w;
+		for(size_t i=0;i<16;i++)
+			w[i] = uint32_t(block[4*i])<<24 | uint32_t(block[4*i+1])<<16 | uint32_t(block[4*i+2])<<8 | uint32_t(block[4*i+3]);
+		for(size_t i=16;i<64;i++) {
+			const uint32_t s0 = std::rotr(w[i-15], 7) ^ std::rotr(w[i-15], 18) ^ (w[i-15] >> 3);
+			const uint32_t s1 = std::rotr(w[i-2], 17) ^ std::rotr(w[i-2], 19) ^ (w[i-2] >> 10);
+			w[i] = w[i-16] + s0 + w[i-7] + s1;
+		}
+
+		uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+		for(size_t i=0;i<64;i++) {
+			const uint32_t t1 = h + (std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25)) + ((e & f) ^ (~e & g)) + sha256_k[i] + w[i];
+			const uint32_t t2 = (std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+			h = g; g = f; f = e; e = d + t1;
+			d = c; c = b; b = a; a = t1 + t2;
+		}
+		state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+		state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+	}
+
+	inline void Sha256::update(std::span<const std::byte> data)
+	{
+		length += data.size();
+		size_t i = 0;
+		if(buffered) {
+			const size_t n = std::min(block_size-buffered, data.size());
+			std::copy_n(data.begin(), n, buffer.begin()+buffered);
+			buffered += n;
+			i = n;
+			if(buffered < block_size) return;
+			compress(buffer.data());
+			buffered = 0;
+		}
+		for(;i+block_size<=data.size();i+=block_size)
+			compress(data.data()+i);
+		std::copy(data.begin()+i, data.end(), buffer.begin());
+		buffered = data.size()-i;
+	}
+
+	inline Sha256::digest_type Sha256::finish()
+	{
+		// 0x80, zeros up to 56 bytes mod 64 and the message length in bits, big endian
+		const uint64_t bits = length*8;
+		std::array<std::byte, block_size+8> pad{};
+		pad[0] = std::byte(0x80);
+		const size_t zeros = (buffered < 56 ? 56 : 120)-buffered;
+		for(size_t i=0;i<8;i++)
+			pad[zeros+i] = std::byte(bits >> (56-8*i));
+		update(std::span<const std::byte>(pad.data(), zeros+8));
+
+		digest_type digest;
+		for(size_t i=0;i<8;i++)
+			for(size_t j=0;j<4;j++)
+				digest[4*i+j] = std::byte(state[i] >> (24-8*j));
+		return digest;
+	}
+
+	inline Sha256::digest_type sha256(std::span<const std::byte> data)
+	{
+		Sha256 hash;
+		hash.update(data);
+		return hash.finish();
+	}
+}; /* NAMESPACE HASH */
+
+#endif /* SHA256_CPP */
@@ -0,0 +1,46 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <span>
+
+// SHA-256 (FIPS 180-4) for the OAEP padding and its mask generation function, bytes in and a 32 byte digest out
+
+namespace Hash
+{
+	class Sha256
+	{
+		public:
+			constexpr static size_t digest_size = 32;
+			constexpr static size_t block_size = 64;
+			typedef std::array<std::byte, digest_size> digest_type;
+
+			Sha256();
+
+			// can be called any number of times before finish
+			void update(std::span<const std::byte> data);
+
+			// pads the message and returns its digest, the object has to be reset before it's used again
+			digest_type finish();
+
+			void reset();
+
+		protected:
+			std::array<uint32_t, 8> state;
+			std::array<std::byte, block_size> buffer;
+			size_t buffered; // bytes in buffer
+			uint64_t length; // message bytes so far
+
+			void compress(const std::byte *block);
+	};
+
+	// digest of data in one call
+	inline Sha256::digest_type sha256(std::span<const std::byte> data);
+}; /* NAMESPACE HASH */
+
+// include here because of the single translation unit build
+#include "sha256.cpp"
+
+#endif /* SHA256_H */